@@ -4,25 +4,28 @@
 #include "searches/searches.h"
 #include "searches/apps.h"
 #include "searches/settings.h"
+#include "searches/spotlightapps.h"
+#include "searches/files.h"
+#include "searches/scheduler.h"
+#include "searches/catalogbuilder.h"
 #include "spotlightapps/spotlightapp.h"
 #include "spotlightapps/demo/demoapp.h"
-#include "spotlightapps/utils.h"
+#include "results/resultsmodel.h"
+#include "results/resultdelegate.h"
+#include "launcher.h"
 #include <QHash>
 #include <QList>
 #include <QKeyEvent>
+#include <QHideEvent>
 #include <QLineEdit>
 #include <QVBoxLayout>
 #include <QMouseEvent>
-#include <QProcess>
 #include <QFrame>
 #include <QSizePolicy>
-#include <QScrollArea>
+#include <QListView>
 #include <QScreen>
+#include <QStyle>
 #include <QApplication>
-#include <QLabel>
-#include <QHBoxLayout>
-#include <QFontMetrics>
-#include <QSpacerItem>
 #include <vector>
 #include <algorithm>
 
@@ -66,8 +69,20 @@ Spotlight::Spotlight(QWidget* parent)
   layout->setContentsMargins(16, 16, 16, 16);
   layout->setSpacing(0);
   
+  // one stylesheet for both shapes, updateBorderRadius only flips the property
   m_unifiedContainer = new QWidget(this);
-  updateBorderRadius(false);
+  m_unifiedContainer->setObjectName("unifiedContainer");
+  m_unifiedContainer->setProperty("hasResults", false);
+  m_unifiedContainer->setStyleSheet(QString(
+    "#unifiedContainer {"
+    "  background: rgba(40, 40, 40, 250);"
+    "  border-radius: %1px;"
+    "}"
+    "#unifiedContainer[hasResults=\"true\"] {"
+    "  border-bottom-left-radius: 0px;"
+    "  border-bottom-right-radius: 0px;"
+    "}"
+  ).arg(BORDER_RADIUS));
   m_unifiedContainer->installEventFilter(this);
   
   m_unifiedLayout = new QVBoxLayout(m_unifiedContainer);
@@ -124,20 +139,25 @@ Spotlight::Spotlight(QWidget* parent)
   
   m_unifiedLayout->addWidget(m_inputContainer);
   
-  QScrollArea* scrollArea = new QScrollArea(m_unifiedContainer);
-  scrollArea->setWidgetResizable(true);
-  scrollArea->setFrameShape(QFrame::NoFrame);
-  scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-  scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-  scrollArea->setStyleSheet(
-    "QScrollArea {"
+  // results list, rows are painted by the delegate so only visible ones cost anything
+  m_resultsModel = new ResultsModel(this);
+  m_resultsView = new QListView(m_unifiedContainer);
+  m_resultsView->setModel(m_resultsModel);
+  m_resultsView->setItemDelegate(new ResultDelegate(m_resultsView));
+  m_resultsView->setUniformItemSizes(true);
+  m_resultsView->setSelectionMode(QAbstractItemView::SingleSelection);
+  m_resultsView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  m_resultsView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+  m_resultsView->setFocusPolicy(Qt::NoFocus); // typing and arrows stay with the input
+  m_resultsView->setFrameShape(QFrame::NoFrame);
+  m_resultsView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  m_resultsView->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+  m_resultsView->setStyleSheet(
+    "QListView, QListView > QWidget {"
     "  background: transparent;"
     "  border: none;"
     "  border-radius: 0px;"
     "}"
-    "QScrollArea > QWidget > QWidget {"
-    "  border-radius: 0px;"
-    "}"
     "QScrollBar:vertical {"
     "  background: rgba(255, 255, 255, 15);"
     "  width: 6px;"
@@ -152,23 +172,16 @@ Spotlight::Spotlight(QWidget* parent)
     "  background: rgba(255, 255, 255, 70);"
     "}"
   );
-  
-  m_actionsContainer = new QWidget();
-  m_actionsContainer->setStyleSheet(
-    "QWidget {"
-    "  background: transparent;"
-    "  border: none;"
-    "  border-radius: 0px;"
-    "}"
-  );
-  m_actionsLayout = new QVBoxLayout(m_actionsContainer);
-  m_actionsLayout->setContentsMargins(4, 4, 4, 4);
-  m_actionsLayout->setSpacing(0);
-  
-  scrollArea->setWidget(m_actionsContainer);
-  scrollArea->hide();
-  m_scrollArea = scrollArea;
-  m_unifiedLayout->addWidget(scrollArea);
+  m_resultsView->viewport()->setCursor(Qt::PointingHandCursor);
+  m_resultsView->viewport()->installEventFilter(this);
+  m_resultsView->hide();
+  m_unifiedLayout->addWidget(m_resultsView);
+  
+  // the search action is reused for every query, it's shown as the last row
+  auto* searchAction = new SearchAction(this);
+  searchAction->hide();
+  connect(searchAction, &Action::actionExecuted, this, &Spotlight::onActionExecuted);
+  m_actions.append(searchAction);
   
   layout->addWidget(m_unifiedContainer);
   
@@ -182,110 +195,121 @@ Spotlight::Spotlight(QWidget* parent)
   m_fixedPosition = center;
   m_positionInitialized = true;
   
-  m_appsSearch = new AppsSearch(this);
-  m_settingsSearch = new SettingsSearch(this);
+  // providers all run at once on the scheduler's worker threads
+  m_scheduler = new SearchScheduler(this);
+  
+  // apps and settings share one scan of the application directories; the
+  // builder is the scheduler's child so it outlives the loading threads
+  auto* catalogBuilder = new CatalogBuilder(m_scheduler);
+  m_settingsSearch = new SettingsSearch(catalogBuilder);
+  m_appsSearch = new AppsSearch(catalogBuilder);
+  m_spotlightAppsSearch = new SpotlightAppsSearch();
+  m_filesSearch = new FilesSearch();
   registerSpotlightApp("demo", new DemoApp());
   
+  m_scheduler->addProvider(m_settingsSearch);
+  m_scheduler->addProvider(m_appsSearch);
+  m_scheduler->addProvider(m_spotlightAppsSearch);
+  m_scheduler->addProvider(m_filesSearch); // last, so apps win ties
+  connect(m_scheduler, &SearchScheduler::resultsReady, this, &Spotlight::onSearchResults);
+  connect(m_scheduler, &SearchScheduler::catalogChanged, this, &Spotlight::onCatalogChanged);
+  
+  // catalogs load in the background from now on, not on the first keystroke
+  m_scheduler->load();
+  
   connect(m_input, &QLineEdit::textChanged, this, &Spotlight::onTextChanged);
 }
 
+void Spotlight::toggle()
+{
+  if (isVisible()) {
+    close();
+    return;
+  }
+  
+  move(m_fixedPosition);
+  show();
+  raise();
+  activateWindow();
+  m_input->setFocus();
+}
+
+void Spotlight::hideEvent(QHideEvent* event)
+{
+  // a resident window comes back empty, the way a fresh launch would
+  if (m_menuMode) { exitMenuMode(); }
+  m_input->clear();
+  
+  QDialog::hideEvent(event);
+}
+
 void Spotlight::onTextChanged(const QString& text)
 {
   if (m_menuMode) return;
   
   if (text.isEmpty()) {
+    m_scheduler->cancel();
     clearActions();
   } else {
-    updateActions(text);
+    // results come back through onSearchResults, the old list stays until then
+    m_scheduler->submit(text);
   }
 }
 
-void Spotlight::updateActions(const QString& query)
+void Spotlight::onCatalogChanged()
 {
-  // clear widgets without ui updates
-  QLayoutItem* item;
-  while ((item = m_actionsLayout->takeAt(0)) != nullptr) {
-    delete item->widget();
-    delete item;
-  }
-  m_actions.clear();
-  m_searchResults.clear();
-  m_currentSearchResults.clear();
-  m_selectedActionIndex = -1;
+  if (m_menuMode || m_input->text().isEmpty()) return;
   
-  std::vector<SearchResult> allResults;
+  // rerun so a query typed during loading picks up the new entries
+  m_refreshGeneration = m_scheduler->submit(m_input->text());
+}
+
+void Spotlight::onSearchResults(quint64 generation, const QString& query, const ResultList& results)
+{
+  if (m_menuMode) return;
   
-  // app & settings search
-  std::vector<SearchResult> settingsResults = m_settingsSearch->performSearch(query);
-  std::vector<SearchResult> appResults = m_appsSearch->performSearch(query);
-  allResults.insert(allResults.end(), settingsResults.begin(), settingsResults.end());
-  allResults.insert(allResults.end(), appResults.begin(), appResults.end());
+  // late providers republish the same generation and catalog refreshes rerun
+  // the same query, keep the user's place for both
+  bool keepSelection = (generation == m_shownGeneration || generation == m_refreshGeneration);
+  m_shownGeneration = generation;
   
-  // add spotlight apps using registry
-  QString lowerQuery = query.toLower();
-  for (const SpotlightAppInfo& appInfo : SPOTLIGHT_APPS) {
-    if (!m_spotlightApps.contains(appInfo.identifier)) continue;
-    
-    QString appNameLower = appInfo.name.toLower();
-    QString appDescLower = appInfo.description.toLower();
-    int score = 0;
-    
-    if (appNameLower.contains(lowerQuery)) {
-      score = 90;
-    } else if (appDescLower.contains(lowerQuery)) {
-      score = 70;
-    } else if (query.isEmpty() || lowerQuery.length() < 2) {
-      score = 50;
-    }
-    
-    if (score > 0) {
-      SearchResult result;
-      result.name = appInfo.name;
-      result.description = appInfo.description;
-      result.exec = "spotlightapp:" + appInfo.identifier;
-      result.score = score;
-      allResults.push_back(result);
-    }
+  updateActions(query, results, keepSelection);
+}
+
+void Spotlight::updateActions(const QString& query, const ResultList& results, bool keepSelection)
+{
+  // what was selected before the update, found again below
+  const int previousResultCount = static_cast<int>(m_currentSearchResults.size());
+  int previousSelection = keepSelection ? m_selectedActionIndex : -1;
+  QString previousId;
+  if (previousSelection >= 0 && previousSelection < previousResultCount) {
+    previousId = m_currentSearchResults.results[previousSelection].entry().id;
   }
   
-  std::sort(allResults.begin(), allResults.end());
-  m_currentSearchResults = allResults;
+  m_currentSearchResults = results;
+  m_selectedActionIndex = -1;
   
-  // Create result buttons
-  for (size_t i = 0; i < allResults.size(); ++i) {
-    createItemButton(allResults[i].name, allResults[i].description, static_cast<int>(i), false);
+  // the model reads result rows from the entries, only actions need rows
+  std::vector<ResultRow> rows;
+  rows.reserve(m_actions.size());
+  for (Action* action : m_actions) {
+    action->setText("Search " + query);
+    
+    ResultRow row;
+    row.title = action->text();
+    rows.push_back(std::move(row));
   }
-  
-  // Create search action
-  auto* searchAction = new SearchAction(m_actionsContainer);
-  searchAction->setText("Search " + query);
-  searchAction->setMinimumHeight(48);
-  searchAction->setStyleSheet(
-    "QPushButton {"
-    "  font-size: 16px;"
-    "  padding: 12px 16px;"
-    "  color: white;"
-    "  background: transparent;"
-    "  border: none;"
-    "  text-align: left;"
-    "}"
-  );
-  connect(searchAction, &Action::actionExecuted, this, &Spotlight::onActionExecuted);
-  connect(searchAction, &QPushButton::clicked, [this, searchAction]() {
-    searchAction->execute(m_input->text());
-  });
-  m_actions.append(searchAction);
-  m_actionsLayout->addWidget(searchAction);
+  m_resultsModel->setRows(results, std::move(rows));
   
   // Show results if any
-  int totalItems = m_searchResults.size() + m_actions.size();
+  int totalItems = m_resultsModel->rowCount();
   if (totalItems > 0) {
-    m_scrollArea->show();
+    m_resultsView->show();
     updateBorderRadius(true);
     updateWindowSize(calculateResultsHeight(totalItems));
-    selectAction(0);
+    selectAction(findSelectionAfterUpdate(previousSelection, previousResultCount, previousId));
   } else {
-    m_scrollArea->hide();
+    m_resultsView->hide();
     updateBorderRadius(false);
     setFixedSize(WINDOW_WIDTH, m_baseHeight);
     if (m_positionInitialized) { move(m_fixedPosition); }
@@ -293,19 +317,30 @@ void Spotlight::updateActions(const QString& query)
   m_input->setFocus();
 }
 
-void Spotlight::clearActions()
+int Spotlight::findSelectionAfterUpdate(int previousSelection, int previousResultCount, const QString& previousId) const
 {
-  QLayoutItem* item;
-  while ((item = m_actionsLayout->takeAt(0)) != nullptr) {
-    delete item->widget();
-    delete item;
+  if (previousSelection < 0) return 0;
+  
+  const int resultCount = static_cast<int>(m_currentSearchResults.size());
+  
+  // an action stays selected at its new position below the results
+  if (previousSelection >= previousResultCount) {
+    int index = resultCount + (previousSelection - previousResultCount);
+    return index < resultCount + m_actions.size() ? index : 0;
   }
   
-  m_actions.clear();
-  m_searchResults.clear();
+  for (int i = 0; i < resultCount; ++i) {
+    if (m_currentSearchResults.results[i].entry().id == previousId) { return i; }
+  }
+  return 0;
+}
+
+void Spotlight::clearActions()
+{
+  m_resultsModel->clear();
   m_currentSearchResults.clear();
   m_selectedActionIndex = -1;
-  m_scrollArea->hide();
+  m_resultsView->hide();
   updateBorderRadius(false);
   setFixedSize(WINDOW_WIDTH, m_baseHeight);
   
@@ -314,93 +349,26 @@ void Spotlight::clearActions()
 
 void Spotlight::navigateActions(int direction)
 {
-  if (m_menuMode) {
-    // navigate menu items
-    int totalItems = static_cast<int>(m_menuItems.size());
-    if (totalItems == 0) return;
-    
-    int newIndex = m_selectedActionIndex + direction;
-    if (newIndex < 0) { newIndex = totalItems - 1; }
-    else if (newIndex >= totalItems) { newIndex = 0; }
-    
-    selectAction(newIndex);
-  } else {
-    // navigate search results
-    int totalItems = m_searchResults.size() + m_actions.size();
-    if (totalItems == 0) return;
-    
-    int newIndex = m_selectedActionIndex + direction;
-    if (newIndex < 0) { newIndex = totalItems - 1; }
-    else if (newIndex >= totalItems) { newIndex = 0; }
-    
-    selectAction(newIndex);
-  }
-}
-
-QPushButton* Spotlight::getButtonAt(int index)
-{
-  if (m_menuMode) {
-    if (index >= 0 && index < static_cast<int>(m_menuItems.size())) {
-      return m_menuItems[index];
-    }
-  } else {
-    if (index < m_searchResults.size()) {
-      return m_searchResults[index];
-    } else if (index < m_searchResults.size() + m_actions.size()) {
-      return m_actions[index - m_searchResults.size()];
-    }
-  }
-  return nullptr;
-}
-
-void Spotlight::applyButtonStyle(QPushButton* button, bool selected)
-{
-  if (!button) return;
+  // menu items or search results + actions, whichever the list shows
+  int totalItems = m_resultsModel->rowCount();
+  if (totalItems == 0) return;
   
-  QWidget* widget = qobject_cast<QWidget*>(button);
-  bool isWidgetButton = (widget && (widget->property("isMenuItem").toBool() || 
-                                    widget->property("isResultButton").toBool()));
+  int newIndex = m_selectedActionIndex + direction;
+  if (newIndex < 0) { newIndex = totalItems - 1; }
+  else if (newIndex >= totalItems) { newIndex = 0; }
   
-  if (isWidgetButton) {
-    SpotlightMenuUtils::styleMenuItemWidget(widget, selected);
-  } else {
-    QString style = QString(
-      "QPushButton {"
-      "  font-size: 16px;"
-      "  padding: 12px 16px;"
-      "  color: white;"
-      "  background: %1;"
-      "  border: none;"
-      "  text-align: left;"
-      "}").arg(selected ? "rgba(100, 150, 255, 80)" : "transparent");
-    button->setStyleSheet(style);
-  }
+  selectAction(newIndex);
 }
 
 void Spotlight::selectAction(int index)
 {
-  int totalItems = m_menuMode ? static_cast<int>(m_menuItems.size()) : 
-                                (m_searchResults.size() + m_actions.size());
+  int totalItems = m_resultsModel->rowCount();
   if (index < 0 || index >= totalItems) return;
   
-  // deselect previous
-  if (m_selectedActionIndex >= 0 && m_selectedActionIndex < totalItems) {
-    QPushButton* prevButton = getButtonAt(m_selectedActionIndex);
-    applyButtonStyle(prevButton, false);
-  }
-  
   m_selectedActionIndex = index;
-  QPushButton* newButton = getButtonAt(index);
-  if (newButton) {
-    QWidget* newWidget = qobject_cast<QWidget*>(newButton);
-    bool isWidgetButton = (newWidget && (newWidget->property("isMenuItem").toBool() || 
-                                         newWidget->property("isResultButton").toBool()));
-    if (isWidgetButton) {
-      SpotlightMenuUtils::styleMenuItemWidget(newWidget, true);
-    } else {
-      applyButtonStyle(newButton, true);
-    }
-  }
+  QModelIndex modelIndex = m_resultsModel->index(index);
+  m_resultsView->setCurrentIndex(modelIndex);
+  m_resultsView->scrollTo(modelIndex);
   
   if (m_menuMode) {
     m_backButton->setFocus();
@@ -409,6 +377,34 @@ void Spotlight::selectAction(int index)
   }
 }
 
+void Spotlight::activateRow(int index)
+{
+  if (m_menuMode) {
+    // stays in menu mode so more items can be picked
+    onMenuItemClicked(index);
+    return;
+  }
+  
+  const int resultCount = static_cast<int>(m_currentSearchResults.size());
+  if (index < 0 || index >= resultCount + m_actions.size()) return;
+  
+  if (index < resultCount) {
+    // search result, the entry is copied since launching may clear the list
+    const CatalogEntry entry = m_currentSearchResults.results[index].entry();
+    m_scheduler->recordLaunch(m_input->text(), entry.id);
+    launchApp(entry);
+    // Don't close if spotlight app (menu mode)
+    if (!entry.exec.startsWith("spotlightapp:")) {
+      close();
+    }
+  } else {
+    // action
+    QString query = m_input->text();
+    m_actions[index - resultCount]->execute(query);
+    close();
+  }
+}
+
 void Spotlight::onActionExecuted() { close(); }
 
 bool Spotlight::eventFilter(QObject* obj, QEvent* event)
@@ -453,66 +449,19 @@ bool Spotlight::eventFilter(QObject* obj, QEvent* event)
         return true;
       }
       else if (keyEvent->key() == Qt::Key_Return || keyEvent->key() == Qt::Key_Enter) {
-        if (m_menuMode) {
-          // menu mode - handle menu item selection
-          int totalItems = static_cast<int>(m_menuItems.size());
-          if (m_selectedActionIndex >= 0 && m_selectedActionIndex < totalItems) {
-            onMenuItemClicked(m_selectedActionIndex);
-          }
-          return true;
-        } else {
-          // search mode
-          int totalItems = m_searchResults.size() + m_actions.size();
-          if (m_selectedActionIndex >= 0 && m_selectedActionIndex < totalItems) {
-            if (m_selectedActionIndex < m_searchResults.size()) {
-              // search result
-              SearchResult result = m_currentSearchResults[m_selectedActionIndex];
-              launchApp(result);
-              // Don't close if spotlight app (menu mode)
-              if (!result.exec.startsWith("spotlightapp:")) {
-                close();
-              }
-            } else {
-              // action
-              QString query = m_input->text();
-              m_actions[m_selectedActionIndex - m_searchResults.size()]->execute(query);
-              close();
-            }
-          }
-          return true;
-        }
-      }
-    }
-  }
-  
-  // Click events on result buttons
-  if (obj->property("isResultButton").toBool()) {
-    if (event->type() == QEvent::MouseButtonPress) {
-      auto* mouseEvent = static_cast<QMouseEvent*>(event);
-      if (mouseEvent->button() == Qt::LeftButton) {
-        int index = obj->property("resultIndex").toInt();
-        if (index >= 0 && index < static_cast<int>(m_currentSearchResults.size())) {
-          SearchResult result = m_currentSearchResults[index];
-          launchApp(result);
-          // Don't close if it's a spotlight app (menu mode)
-          if (!result.exec.startsWith("spotlightapp:")) {
-            close();
-          }
-        }
+        activateRow(m_selectedActionIndex);
         return true;
       }
     }
   }
   
-  // Click events on menu item buttons
-  if (obj->property("isMenuItem").toBool()) {
+  // click events on result/menu rows
+  if (obj == m_resultsView->viewport()) {
     if (event->type() == QEvent::MouseButtonPress) {
       auto* mouseEvent = static_cast<QMouseEvent*>(event);
       if (mouseEvent->button() == Qt::LeftButton) {
-        int index = obj->property("itemIndex").toInt();
-        if (index >= 0 && index < static_cast<int>(m_currentMenuItems.size())) {
-          onMenuItemClicked(index);
-        }
+        QModelIndex index = m_resultsView->indexAt(mouseEvent->pos());
+        if (index.isValid()) { activateRow(index.row()); }
         return true;
       }
     }
@@ -523,14 +472,13 @@ bool Spotlight::eventFilter(QObject* obj, QEvent* event)
     if (event->type() == QEvent::MouseButtonPress) {
       auto* mouseEvent = static_cast<QMouseEvent*>(event);
       if (mouseEvent->button() == Qt::LeftButton) {
-        // if click is on QLineEdit or result buttons, don't drag
+        // if click is on QLineEdit or the results list, don't drag
         QPoint localPos = mouseEvent->pos();
         QWidget* child = m_unifiedContainer->childAt(localPos);
         QWidget* widget = child;
         while (widget && widget != m_unifiedContainer) {
-          if (widget == m_input || widget->property("isResultButton").toBool() || 
-              widget->property("isMenuItem").toBool()) {
-            // click on input or result button, let it handle
+          if (widget == m_input || widget == m_resultsView) {
+            // click on input or results, let it handle
             return false;
           }
           widget = widget->parentWidget();
@@ -558,37 +506,23 @@ bool Spotlight::eventFilter(QObject* obj, QEvent* event)
   return QDialog::eventFilter(obj, event);
 }
 
-void Spotlight::createItemButton(const QString& title, const QString& description, int index, bool isMenuItem, const QFont& font)
-{
-  QWidget* buttonWidget = SpotlightMenuUtils::createMenuItemWidget(m_actionsContainer, title, description, font);
-  
-  // make it clickable
-  buttonWidget->installEventFilter(this);
-  if (isMenuItem) {
-    buttonWidget->setProperty("isMenuItem", true);
-    buttonWidget->setProperty("itemIndex", index);
-    m_menuItems.append(reinterpret_cast<QPushButton*>(buttonWidget));
-  } else {
-    buttonWidget->setProperty("isResultButton", true);
-    buttonWidget->setProperty("resultIndex", index);
-    m_searchResults.append(reinterpret_cast<QPushButton*>(buttonWidget));
-  }
-  m_actionsLayout->addWidget(buttonWidget);
-}
-
-
 void Spotlight::registerSpotlightApp(const QString& appName, SpotlightApp* app)
 {
   m_spotlightApps[appName] = app;
+  
+  // make it searchable if it's listed in the registry
+  for (const SpotlightAppInfo& appInfo : SPOTLIGHT_APPS) {
+    if (appInfo.identifier == appName) { m_spotlightAppsSearch->addApp(appInfo); }
+  }
 }
 
-void Spotlight::launchApp(const SearchResult& result)
+void Spotlight::launchApp(const CatalogEntry& entry)
 {
-  if (result.exec.isEmpty()) return;
+  if (entry.exec.isEmpty()) return;
   
   // check if this is a spotlight app
-  if (result.exec.startsWith("spotlightapp:")) {
-    QString appName = result.exec.mid(13); // remove "spotlightapp:" prefix
+  if (entry.exec.startsWith("spotlightapp:")) {
+    QString appName = entry.exec.mid(13); // remove "spotlightapp:" prefix
     
     if (m_spotlightApps.contains(appName)) {
       SpotlightApp* app = m_spotlightApps[appName];
@@ -597,25 +531,15 @@ void Spotlight::launchApp(const SearchResult& result)
     }
   }
   
-  QString execCmd = result.exec;
-  
-  // remove desktop file % codes
-  execCmd.replace("%f", "");
-  execCmd.replace("%F", "");
-  execCmd.replace("%u", "");
-  execCmd.replace("%U", "");
-  execCmd.replace("%i", "");
-  execCmd.replace("%c", result.name);
-  execCmd.replace("%k", "");
-  
-  // launch via bash to use correct shell environment
-  QProcess::startDetached("bash", QStringList() << "-c" << execCmd);
+  // spawned directly, only lines with shell syntax go through bash
+  Launcher::launch({entry.exec, entry.name, entry.icon, entry.desktopFile()});
   
   emit onActionExecuted();
 }
 
 void Spotlight::showMenuMode(const std::vector<MenuItem>& items)
 {
+  m_scheduler->cancel();
   m_menuMode = true;
   m_currentMenuItems = items;
   
@@ -624,13 +548,21 @@ void Spotlight::showMenuMode(const std::vector<MenuItem>& items)
   m_backButton->show();
   clearActions();
   
-  for (size_t i = 0; i < items.size(); ++i) {
-    createItemButton(items[i].title, items[i].description, static_cast<int>(i), true, items[i].font);
+  std::vector<ResultRow> rows;
+  rows.reserve(items.size());
+  for (const MenuItem& item : items) {
+    ResultRow row;
+    row.title = item.title;
+    row.description = item.description;
+    row.font = item.font;
+    row.hasFont = !item.font.family().isEmpty();
+    rows.push_back(std::move(row));
   }
+  m_resultsModel->setRows(std::move(rows));
   
   int totalItems = static_cast<int>(items.size());
   if (totalItems > 0) {
-    m_scrollArea->show();
+    m_resultsView->show();
     updateBorderRadius(true);
     
     int resultsHeight = calculateResultsHeight(totalItems);
@@ -649,7 +581,6 @@ void Spotlight::exitMenuMode()
   m_input->clear();
   m_input->setFocus();
   clearActions();
-  m_menuItems.clear();
   m_currentMenuItems.clear();
 }
 
@@ -659,33 +590,29 @@ void Spotlight::onMenuBackClicked()
 // Helper functions
 void Spotlight::updateBorderRadius(bool hasResults)
 {
-  QString style = QString(
-    "QWidget {"
-    "  background: rgba(40, 40, 40, 250);"
-    "  border-top-left-radius: %1px;"
-    "  border-top-right-radius: %1px;"
-    "  border-bottom-left-radius: %2px;"
-    "  border-bottom-right-radius: %2px;"
-    "}"
-  ).arg(BORDER_RADIUS).arg(hasResults ? 0 : BORDER_RADIUS);
+  // called on every query, so only re-polish when the shape actually changes
+  if (m_unifiedContainer->property("hasResults").toBool() == hasResults) return;
   
-  m_unifiedContainer->setStyleSheet(style);
+  m_unifiedContainer->setProperty("hasResults", hasResults);
+  m_unifiedContainer->style()->unpolish(m_unifiedContainer);
+  m_unifiedContainer->style()->polish(m_unifiedContainer);
+  m_unifiedContainer->update();
 }
 
 int Spotlight::calculateResultsHeight(int totalItems)
 {
   if (totalItems == 0) return 0;
   
-  // each item is 48px tall
-  int contentHeight = totalItems * 48;
+  // each item is a fixed-height row
+  int contentHeight = totalItems * ResultDelegate::ROW_HEIGHT;
   
   return qMin(contentHeight, m_maxResultsHeight);
 }
 
 void Spotlight::updateWindowSize(int resultsHeight)
 {
-  m_scrollArea->setMaximumHeight(resultsHeight);
-  m_scrollArea->setMinimumHeight(resultsHeight);
+  m_resultsView->setMaximumHeight(resultsHeight);
+  m_resultsView->setMinimumHeight(resultsHeight);
   
   int windowHeight = MARGIN_TOP + SEARCH_BOX_HEIGHT + resultsHeight + MARGIN_BOTTOM;
   setFixedSize(WINDOW_WIDTH, windowHeight);
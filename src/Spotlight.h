@@ -7,6 +7,8 @@
 #include <functional>
 #include <vector>
 #include "searches/searches.h"
+#include "searches/catalog.h"
+#include "searches/spotlightappinfo.h"
 
 struct MenuItem
 {
@@ -19,24 +21,18 @@ struct MenuItem
     : title(t), description(d), action(a), font(f) {}
 };
 
-struct SpotlightAppInfo
-{
-  QString identifier;
-  QString name;
-  QString description;
-  
-  SpotlightAppInfo(const QString& id, const QString& n, const QString& desc)
-    : identifier(id), name(n), description(desc) {}
-};
-
 class QLineEdit;
 class QWidget;
 class QVBoxLayout;
-class QScrollArea;
+class QListView;
 class Action;
 class QPushButton;
+class ResultsModel;
 class AppsSearch;
 class SettingsSearch;
+class SpotlightAppsSearch;
+class FilesSearch;
+class SearchScheduler;
 class SpotlightApp;
 
 class Spotlight : public QDialog
@@ -45,20 +41,27 @@ class Spotlight : public QDialog
 public:
   explicit Spotlight(QWidget* parent = nullptr);
 
+public slots:
+  // show with focus in the input, or hide if already showing
+  void toggle();
+
 protected:
   bool eventFilter(QObject* obj, QEvent* event) override;
+  void hideEvent(QHideEvent* event) override;
 
 private slots:
   void onTextChanged(const QString& text);
+  void onSearchResults(quint64 generation, const QString& query, const ResultList& results);
+  void onCatalogChanged();
   void onActionExecuted();
 
 private:
-  void updateActions(const QString& query);
+  void updateActions(const QString& query, const ResultList& results, bool keepSelection);
+  int findSelectionAfterUpdate(int previousSelection, int previousResultCount, const QString& previousId) const;
   void clearActions();
   void navigateActions(int direction);
   void selectAction(int index);
-  void applyButtonStyle(QPushButton* button, bool selected);
-  QPushButton* getButtonAt(int index);
+  void activateRow(int index); // launch/execute whatever the row at index is
   
   // Menu mode functions
   void showMenuMode(const std::vector<MenuItem>& items);
@@ -75,17 +78,19 @@ private:
   QPushButton* m_backButton = nullptr;
   QWidget* m_unifiedContainer = nullptr; // Unified container for search and results
   QWidget* m_inputContainer = nullptr; // Input area inside unified container
-  QWidget* m_actionsContainer = nullptr;
-  QScrollArea* m_scrollArea = nullptr;
-  QVBoxLayout* m_actionsLayout = nullptr;
+  QListView* m_resultsView = nullptr; // results or menu items, painted by ResultDelegate
+  ResultsModel* m_resultsModel = nullptr;
   QVBoxLayout* m_unifiedLayout = nullptr; // Layout for unified container
-  QList<Action*> m_actions;
-  QList<QPushButton*> m_searchResults; // buttons for search results
-  QList<QPushButton*> m_menuItems; // buttons for menu items
-  std::vector<SearchResult> m_currentSearchResults; // store search results data
+  QList<Action*> m_actions; // shown as rows after the search results
+  ResultList m_currentSearchResults; // handles into the catalogs, shown first
   std::vector<MenuItem> m_currentMenuItems; // store menu items data
+  SearchScheduler* m_scheduler = nullptr; // owns the search providers below
   AppsSearch* m_appsSearch = nullptr;
   SettingsSearch* m_settingsSearch = nullptr;
+  SpotlightAppsSearch* m_spotlightAppsSearch = nullptr;
+  FilesSearch* m_filesSearch = nullptr;
+  quint64 m_shownGeneration = 0; // search generation currently on screen
+  quint64 m_refreshGeneration = 0; // rerun after a catalog change, same query
   QHash<QString, SpotlightApp*> m_spotlightApps; // registered spotlight apps
   int m_selectedActionIndex = -1;
   QPoint m_dragStartPos;
@@ -102,7 +107,6 @@ private:
   static constexpr int MARGIN_BOTTOM = 16;
   static constexpr int BORDER_RADIUS = 28;
   
-  void launchApp(const SearchResult& result);
-  void createItemButton(const QString& title, const QString& description, int index, bool isMenuItem, const QFont& font = QFont());
+  void launchApp(const CatalogEntry& entry);
   void registerSpotlightApp(const QString& appName, SpotlightApp* app);
 };
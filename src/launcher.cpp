@@ -0,0 +1,226 @@
+#include "launcher.h"
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QProcess>
+#include <QSocketNotifier>
+#include <QStringView>
+#include <spawn.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <thread>
+#include <vector>
+
+extern char** environ;
+
+namespace {
+
+// the general string escapes, applied to the whole value before it's split
+QString unescape(const QString& value)
+{
+  QString result;
+  result.reserve(value.size());
+  for (qsizetype i = 0; i < value.size(); ++i) {
+    if (value[i] != '\\' || i + 1 == value.size()) {
+      result.append(value[i]);
+      continue;
+    }
+    
+    QChar next = value[i + 1];
+    if (next == 's') { result.append(' '); }
+    else if (next == 'n') { result.append('\n'); }
+    else if (next == 't') { result.append('\t'); }
+    else if (next == 'r') { result.append('\r'); }
+    else if (next == '\\') { result.append('\\'); }
+    else {
+      // not a string escape, it's for the exec quoting below
+      result.append(value[i]);
+      continue;
+    }
+    ++i;
+  }
+  return result;
+}
+
+// the spec reserves these; unquoted, only a shell would make sense of them
+bool isReserved(QChar c)
+{ return QStringView(u"'\\><~|&;$*?#()`").contains(c); }
+
+bool isSeparator(QChar c)
+{ return c == ' ' || c == '\t' || c == '\n'; }
+
+// field codes that expand to nothing: files and urls spotlight never passes,
+// and the deprecated ones
+bool isDroppedCode(QChar c)
+{ return QStringView(u"fFuUdDnNvm").contains(c); }
+
+// shells get the value quoted as one word
+QString shellQuoted(const QString& text)
+{
+  QString quoted = text;
+  quoted.replace('\'', "'\\''");
+  return '\'' + quoted + '\'';
+}
+
+// the line as a shell command, field codes expanded in place
+QString shellCommand(const Launcher::Entry& entry)
+{
+  const QString line = unescape(entry.exec);
+  QString command;
+  command.reserve(line.size());
+  for (qsizetype i = 0; i < line.size(); ++i) {
+    if (line[i] != '%' || i + 1 == line.size()) {
+      command.append(line[i]);
+      continue;
+    }
+    
+    QChar code = line[++i];
+    if (code == '%') { command.append('%'); }
+    else if (code == 'c') { command.append(shellQuoted(entry.name)); }
+    else if (code == 'k') { command.append(shellQuoted(entry.desktopFile)); }
+    else if (code == 'i') {
+      if (!entry.icon.isEmpty()) { command.append("--icon " + shellQuoted(entry.icon)); }
+    }
+    // anything else, known or not, expands to nothing
+  }
+  return command;
+}
+
+// the child is ours until it exits, so wait for it or it lingers as a zombie
+void reap(pid_t pid)
+{
+#ifdef SYS_pidfd_open
+  // a pidfd turns readable when the child exits, no thread needed
+  int fd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+  if (fd >= 0 && QCoreApplication::instance()) {
+    auto* notifier = new QSocketNotifier(fd, QSocketNotifier::Read, QCoreApplication::instance());
+    QObject::connect(notifier, &QSocketNotifier::activated, notifier, [notifier, pid, fd]() {
+      waitpid(pid, nullptr, WNOHANG);
+      notifier->setEnabled(false);
+      ::close(fd);
+      notifier->deleteLater();
+    });
+    return;
+  }
+  if (fd >= 0) { ::close(fd); }
+#endif
+  
+  // older kernels: a thread that sleeps in waitpid until the child is gone
+  std::thread([pid]() { waitpid(pid, nullptr, 0); }).detach();
+}
+
+} // namespace
+
+bool Launcher::parseExec(const Entry& entry, QStringList& argv)
+{
+  argv.clear();
+  const QString line = unescape(entry.exec);
+  
+  QString arg;
+  bool keep = false; // arg has text or quotes, a lone %F leaves nothing
+  bool quoted = false;
+  
+  for (qsizetype i = 0; i < line.size(); ++i) {
+    QChar c = line[i];
+    
+    if (quoted) {
+      if (c == '"') {
+        quoted = false;
+        continue;
+      }
+      
+      // inside quotes only these four are escaped, other backslashes stay
+      if (c == '\\' && i + 1 < line.size() && QStringView(u"\"`$\\").contains(line[i + 1])) {
+        arg.append(line[++i]);
+        continue;
+      }
+    } else {
+      if (isSeparator(c)) {
+        if (keep) { argv.append(arg); }
+        arg.clear();
+        keep = false;
+        continue;
+      }
+      if (c == '"') {
+        quoted = true;
+        keep = true;
+        continue;
+      }
+      if (isReserved(c)) return false;
+    }
+    
+    if (c != '%') {
+      arg.append(c);
+      keep = true;
+      continue;
+    }
+    
+    if (i + 1 == line.size()) return false;
+    QChar code = line[++i];
+    if (code == '%') {
+      arg.append('%');
+      keep = true;
+    } else if (code == 'c') {
+      arg.append(entry.name);
+      keep = true;
+    } else if (code == 'k') {
+      arg.append(entry.desktopFile);
+      keep = true;
+    } else if (code == 'i') {
+      // expands to two arguments, so it has to stand alone
+      bool standalone = !quoted && arg.isEmpty() && !keep && (i + 1 == line.size() || isSeparator(line[i + 1]));
+      if (!standalone) return false;
+      if (!entry.icon.isEmpty()) { argv << "--icon" << entry.icon; }
+    } else if (!isDroppedCode(code)) {
+      return false;
+    }
+  }
+  
+  if (quoted) return false;
+  if (keep) { argv.append(arg); }
+  return !argv.isEmpty();
+}
+
+bool Launcher::spawn(const QStringList& argv)
+{
+  if (argv.isEmpty()) return false;
+  
+  // posix_spawn wants char*s that live until it returns
+  std::vector<QByteArray> encoded;
+  encoded.reserve(argv.size());
+  for (const QString& arg : argv) { encoded.push_back(arg.toLocal8Bit()); }
+  std::vector<char*> args;
+  args.reserve(encoded.size() + 1);
+  for (QByteArray& arg : encoded) { args.push_back(arg.data()); }
+  args.push_back(nullptr);
+  
+  // a session of its own so it outlives us, with default signal handling
+  // rather than whatever was set up in this process
+  posix_spawnattr_t attr;
+  posix_spawnattr_init(&attr);
+  sigset_t mask;
+  sigemptyset(&mask);
+  posix_spawnattr_setsigmask(&attr, &mask);
+  sigaddset(&mask, SIGPIPE);
+  sigaddset(&mask, SIGCHLD);
+  posix_spawnattr_setsigdefault(&attr, &mask);
+  posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+  
+  pid_t pid = 0;
+  int error = posix_spawnp(&pid, args[0], nullptr, &attr, args.data(), environ);
+  posix_spawnattr_destroy(&attr);
+  if (error != 0) return false;
+  
+  reap(pid);
+  return true;
+}
+
+bool Launcher::launch(const Entry& entry)
+{
+  QStringList argv;
+  if (parseExec(entry, argv)) return spawn(argv);
+  
+  // pipes, redirections and friends; bash for the user's usual environment
+  return QProcess::startDetached("bash", QStringList() << "-c" << shellCommand(entry));
+}
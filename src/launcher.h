@@ -0,0 +1,28 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+
+// starts desktop entry Exec= lines directly, without a shell in between
+class Launcher
+{
+public:
+  // what the field codes expand to
+  struct Entry
+  {
+    QString exec;
+    QString name; // %c
+    QString icon; // %i, as --icon <icon>
+    QString desktopFile; // %k
+  };
+  
+  // split exec into argv per the desktop entry spec (quoting, escapes, field
+  // codes); spotlight never passes files or urls, so %f %F %u %U expand to
+  // nothing. false if the line is malformed or leans on shell syntax
+  static bool parseExec(const Entry& entry, QStringList& argv);
+  
+  // run argv detached in its own session, false if it couldn't be started
+  static bool spawn(const QStringList& argv);
+  
+  // parse and spawn, handing lines that need one to a shell instead
+  static bool launch(const Entry& entry);
+};
@@ -1,12 +1,33 @@
 #include "Spotlight.h"
+#include "singleinstance.h"
 #include <QApplication>
+#include <cstring>
 
 int main(int argc, char** argv)
 {
+  // --background starts the resident instance hidden, e.g. from autostart
+  const bool background = argc > 1 && std::strcmp(argv[1], "--background") == 0;
+  
+  // a resident spotlight is already warm, handing it the toggle beats
+  // starting qt again; checked before QApplication so this exits at once
+  if (background ? SingleInstance::isRunning() : SingleInstance::toggleRunning()) return 0;
+  
   QApplication app(argc, argv);
   
   Spotlight overlay;
-  overlay.show();
+  
+  // stay resident with the window hidden between uses; without the socket
+  // this is a one-shot launcher again and exits on close
+  SingleInstance instance;
+  if (instance.listen()) {
+    QApplication::setQuitOnLastWindowClosed(false);
+    QObject::connect(&instance, &SingleInstance::toggleRequested, &overlay, &Spotlight::toggle);
+  } else if (background) {
+    // hidden with no socket, nothing could ever show the window or quit
+    return 1;
+  }
+  
+  if (!background) { overlay.toggle(); }
   
   return app.exec();
 }
@@ -0,0 +1,73 @@
+#include "resultdelegate.h"
+#include "resultsmodel.h"
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOptionViewItem>
+#include <QModelIndex>
+
+namespace
+{
+  QFont pixelFont(int pixelSize)
+  {
+    QFont font;
+    font.setPixelSize(pixelSize);
+    return font;
+  }
+}
+
+ResultDelegate::ResultDelegate(QObject* parent)
+  : QStyledItemDelegate(parent),
+    m_titleFont(pixelFont(16)),
+    m_descriptionFont(pixelFont(14)),
+    m_titleMetrics(m_titleFont),
+    m_descriptionMetrics(m_descriptionFont),
+    m_titleColor(255, 255, 255),
+    m_descriptionColor(255, 255, 255, 140),
+    m_selectedColor(100, 150, 255, 80)
+{}
+
+void ResultDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+  painter->save();
+  
+  QRect rowRect = option.rect.adjusted(ROW_INSET, 0, -ROW_INSET, 0);
+  if (option.state & QStyle::State_Selected) {
+    painter->fillRect(rowRect, m_selectedColor);
+  }
+  
+  QRect contentRect = rowRect.adjusted(PADDING_X, 0, -PADDING_X, 0);
+  
+  // title, in the row's own font when it has one (font previews)
+  QVariant fontData = index.data(Qt::FontRole);
+  bool customFont = fontData.isValid();
+  QFont titleFont = customFont ? fontData.value<QFont>() : m_titleFont;
+  QFontMetrics titleMetrics = customFont ? QFontMetrics(titleFont) : m_titleMetrics;
+  
+  QString title = titleMetrics.elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideRight, MAX_TEXT_WIDTH);
+  painter->setFont(titleFont);
+  painter->setPen(m_titleColor);
+  painter->drawText(contentRect, Qt::AlignLeft | Qt::AlignVCenter, title);
+  
+  // description follows the title
+  QString description = index.data(ResultsModel::DescriptionRole).toString();
+  if (!description.isEmpty()) {
+    QRect descriptionRect = contentRect;
+    descriptionRect.setLeft(contentRect.left() + titleMetrics.horizontalAdvance(title) + SPACING);
+    
+    int width = qMin(descriptionRect.width(), MAX_TEXT_WIDTH);
+    if (width > 0) {
+      painter->setFont(m_descriptionFont);
+      painter->setPen(m_descriptionColor);
+      painter->drawText(descriptionRect, Qt::AlignLeft | Qt::AlignVCenter,
+                        m_descriptionMetrics.elidedText(description, Qt::ElideRight, width));
+    }
+  }
+  
+  painter->restore();
+}
+
+QSize ResultDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+  Q_UNUSED(index);
+  return QSize(option.rect.width(), ROW_HEIGHT);
+}
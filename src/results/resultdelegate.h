@@ -0,0 +1,34 @@
+#pragma once
+#include <QStyledItemDelegate>
+#include <QFont>
+#include <QFontMetrics>
+#include <QColor>
+
+// paints a result row (title + dimmed description) straight onto the view,
+// so rows cost nothing until they scroll into sight
+class ResultDelegate : public QStyledItemDelegate
+{
+  Q_OBJECT
+public:
+  static constexpr int ROW_HEIGHT = 48;
+  
+  explicit ResultDelegate(QObject* parent = nullptr);
+  
+  void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+  QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+private:
+  static constexpr int ROW_INSET = 4; // gap between rows and the list edge
+  static constexpr int PADDING_X = 16;
+  static constexpr int SPACING = 8;
+  static constexpr int MAX_TEXT_WIDTH = 300; // titles and descriptions elide past this
+  
+  // built once, reused for every row painted
+  QFont m_titleFont;
+  QFont m_descriptionFont;
+  QFontMetrics m_titleMetrics;
+  QFontMetrics m_descriptionMetrics;
+  QColor m_titleColor;
+  QColor m_descriptionColor;
+  QColor m_selectedColor;
+};
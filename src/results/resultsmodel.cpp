@@ -0,0 +1,56 @@
+#include "resultsmodel.h"
+#include "../searches/catalog.h"
+#include <utility>
+
+ResultsModel::ResultsModel(QObject* parent) : QAbstractListModel(parent) {}
+
+void ResultsModel::setRows(std::vector<ResultRow> rows)
+{ setRows(ResultList(), std::move(rows)); }
+
+void ResultsModel::setRows(ResultList results, std::vector<ResultRow> rows)
+{
+  beginResetModel();
+  m_results = std::move(results);
+  m_rows = std::move(rows);
+  endResetModel();
+}
+
+void ResultsModel::clear()
+{
+  if (m_results.empty() && m_rows.empty()) return;
+  
+  beginResetModel();
+  m_results.clear();
+  m_rows.clear();
+  endResetModel();
+}
+
+int ResultsModel::rowCount(const QModelIndex& parent) const
+{
+  if (parent.isValid()) return 0;
+  return static_cast<int>(m_results.size() + m_rows.size());
+}
+
+QVariant ResultsModel::data(const QModelIndex& index, int role) const
+{
+  if (!index.isValid() || index.row() >= rowCount()) return QVariant();
+  
+  // only the rows being painted ever get here, so this is all the copying
+  const int resultCount = static_cast<int>(m_results.size());
+  if (index.row() < resultCount) {
+    const CatalogEntry& entry = m_results.results[index.row()].entry();
+    switch (role) {
+      case Qt::DisplayRole: return entry.name;
+      case DescriptionRole: return entry.description;
+      default: return QVariant();
+    }
+  }
+  
+  const ResultRow& row = m_rows[index.row() - resultCount];
+  switch (role) {
+    case Qt::DisplayRole: return row.title;
+    case DescriptionRole: return row.description;
+    case Qt::FontRole: return row.hasFont ? QVariant(row.font) : QVariant();
+    default: return QVariant();
+  }
+}
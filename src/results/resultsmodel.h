@@ -0,0 +1,40 @@
+#pragma once
+#include "../searches/searches.h"
+#include <QAbstractListModel>
+#include <QString>
+#include <QFont>
+#include <vector>
+
+struct ResultRow
+{
+  QString title;
+  QString description;
+  QFont font; // custom title font, only used when hasFont is set
+  bool hasFont = false;
+};
+
+// rows shown in the results list: search results first, read straight from
+// their catalog entries, then plain rows (actions or menu items)
+class ResultsModel : public QAbstractListModel
+{
+  Q_OBJECT
+public:
+  enum Role
+  {
+    DescriptionRole = Qt::UserRole + 1
+  };
+  
+  explicit ResultsModel(QObject* parent = nullptr);
+  
+  // replace every row in one reset
+  void setRows(std::vector<ResultRow> rows);
+  void setRows(ResultList results, std::vector<ResultRow> rows);
+  void clear();
+  
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+  ResultList m_results;
+  std::vector<ResultRow> m_rows; // after the results
+};
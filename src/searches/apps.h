@@ -1,35 +1,12 @@
 #pragma once
-#include "searches.h"
-#include <QString>
-#include <QList>
+#include "desktopsearch.h"
 
-struct AppInfo
-{
-  QString name;
-  QString exec;
-  QString icon;
-  QString description;
-  QString desktopFile;
-};
-
-class AppsSearch : public Search
+class AppsSearch : public DesktopSearch
 {
   Q_OBJECT
 public:
-  explicit AppsSearch(QObject* parent = nullptr);
-  
-  std::vector<SearchResult> performSearch(const QString& query) override;
-  
-private:
-  // load all applications from desktop files
-  void loadApplications();
-  
-  // parse .desktop file and extract app info
-  AppInfo parseDesktopFile(const QString& filePath);
-  
-  // get desktop file directories
-  QStringList getDesktopFileDirectories();
+  explicit AppsSearch(CatalogBuilder* builder, QObject* parent = nullptr);
   
-  QList<AppInfo> m_applications;
-  bool m_appsLoaded = false;
+  // launchable apps that show up in menus
+  bool accepts(const DesktopEntry& entry) const override;
 };
@@ -0,0 +1,81 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QStringView>
+#include <cstring>
+
+// helpers for the mapped binary files (desktop cache, launch history, path
+// index), native endian since they never leave the machine; strings are a u32
+// length and utf-16 data padded to 4 bytes
+//
+// the files are replaced through QSaveFile, written aside and renamed over, so
+// a crash never leaves half a file and a map of the old one stays valid until
+// it's dropped. maps are page aligned, a record is aligned wherever the layout
+// puts it at a multiple of its size
+
+// bounds-checked reads over a mapped file, one bad read fails the rest
+struct BinaryReader
+{
+  const uchar* data = nullptr;
+  qint64 size = 0;
+  qint64 pos = 0;
+  bool ok = true;
+  
+  template <typename T>
+  T read()
+  {
+    T value{};
+    if (!ok || pos + static_cast<qint64>(sizeof(T)) > size) {
+      ok = false;
+      return value;
+    }
+    std::memcpy(&value, data + pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+  }
+  
+  // strings are 4-byte aligned, so the utf-16 data can be copied straight out
+  QString readString()
+  {
+    qint64 bytes = static_cast<qint64>(read<quint32>()) * 2;
+    if (!ok || pos + bytes > size) {
+      ok = false;
+      return {};
+    }
+    QString text(reinterpret_cast<const QChar*>(data + pos), bytes / 2);
+    pos += (bytes + 3) & ~qint64(3);
+    return text;
+  }
+  
+  void skipString()
+  {
+    qint64 bytes = static_cast<qint64>(read<quint32>()) * 2;
+    pos += (bytes + 3) & ~qint64(3);
+    if (pos > size) { ok = false; }
+  }
+};
+
+template <typename T>
+inline void writeValue(QByteArray& out, T value)
+{ out.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+// FNV-1a over the utf-16 units; qHash is seeded per process, a hash that's
+// written to a file must come out the same every run. pass the last hash on
+// to continue it over more text
+constexpr quint64 STABLE_HASH_BASIS = 14695981039346656037ull;
+
+inline quint64 stableHash(QStringView text, quint64 hash = STABLE_HASH_BASIS)
+{
+  for (QChar c : text) {
+    hash ^= c.unicode();
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+inline void writeString(QByteArray& out, const QString& text)
+{
+  writeValue<quint32>(out, static_cast<quint32>(text.size()));
+  out.append(reinterpret_cast<const char*>(text.utf16()), text.size() * 2);
+  while (out.size() % 4 != 0) { out.append('\0'); }
+}
@@ -0,0 +1,191 @@
+#include "catalog.h"
+#include "fuzzy.h"
+#include <algorithm>
+#include <utility>
+
+void Catalog::clear()
+{
+  m_entries.clear();
+  m_names.clear();
+  m_nameBoundaries.clear();
+  m_nameStarts.assign(1, 0);
+  m_masks.clear();
+  m_strings.clear();
+  m_idIndex.clear();
+  m_words.clear();
+  m_tokens.clear();
+}
+
+void Catalog::reserve(int size)
+{
+  m_entries.reserve(size);
+  m_nameStarts.reserve(size + 1);
+  m_masks.reserve(size);
+  m_idIndex.reserve(size);
+}
+
+bool Catalog::append(CatalogEntry entry)
+{
+  if (!entry.id.isEmpty()) {
+    if (m_idIndex.contains(entry.id)) return false;
+    m_idIndex.insert(entry.id, static_cast<int>(m_entries.size()));
+  }
+  
+  QByteArray boundaries;
+  const QString folded = fold(entry.name, &boundaries);
+  m_names += folded;
+  m_nameBoundaries += boundaries;
+  m_nameStarts.push_back(static_cast<quint32>(m_names.size()));
+  m_masks.push_back(FuzzyMatcher::charMask(folded));
+  
+  // names and execs are mostly unique, these repeat a lot
+  entry.genericName = intern(entry.genericName);
+  entry.description = intern(entry.description);
+  entry.icon = intern(entry.icon);
+  entry.desktopDir = intern(entry.desktopDir);
+  
+  indexEntry(entry, static_cast<int>(m_entries.size()));
+  m_entries.push_back(std::move(entry));
+  return true;
+}
+
+QString Catalog::intern(const QString& text)
+{
+  if (text.isEmpty()) return QString();
+  auto it = m_strings.constFind(text);
+  if (it == m_strings.constEnd()) { it = m_strings.insert(text); }
+  return *it;
+}
+
+void Catalog::indexEntry(const CatalogEntry& entry, int index)
+{
+  m_words.insertWords(foldedName(index), index);
+  indexField(foldedName(index), index, NAME);
+  indexField(fold(entry.localizedName), index, LOCALIZED_NAME);
+  indexField(fold(entry.genericName), index, GENERIC_NAME);
+  indexField(fold(entry.keywords), index, KEYWORDS);
+  indexField(fold(entry.description), index, COMMENT);
+}
+
+void Catalog::indexField(QStringView text, int index, Field field)
+{
+  for (QStringView token : tokens(text)) {
+    std::vector<Posting>& postings = m_tokens[token.toString()];
+    
+    // a word repeated within a field only needs one posting
+    if (!postings.empty() && postings.back().entry == index && postings.back().field == field) continue;
+    postings.push_back({index, field});
+  }
+}
+
+QList<QStringView> Catalog::tokens(QStringView folded)
+{
+  QList<QStringView> result;
+  qsizetype start = -1;
+  for (qsizetype i = 0; i <= folded.size(); ++i) {
+    bool inToken = i < folded.size() && folded[i].isLetterOrNumber();
+    if (inToken && start < 0) {
+      start = i;
+    } else if (!inToken && start >= 0) {
+      result.append(folded.mid(start, i - start));
+      start = -1;
+    }
+  }
+  return result;
+}
+
+bool Catalog::removeId(const QString& id)
+{
+  auto it = m_idIndex.find(id);
+  if (it == m_idIndex.end()) return false;
+  
+  // erase keeps the order (it breaks score ties), so the tail shifts down
+  const int index = *it;
+  m_idIndex.erase(it);
+  m_entries.erase(m_entries.begin() + index);
+  m_masks.erase(m_masks.begin() + index);
+  
+  // cut the name out of the arrays and move the later starts back over it
+  const quint32 start = m_nameStarts[index];
+  const quint32 length = m_nameStarts[index + 1] - start;
+  m_names.remove(start, length);
+  m_nameBoundaries.remove(start, length);
+  m_nameStarts.erase(m_nameStarts.begin() + index + 1);
+  for (size_t i = index + 1; i < m_nameStarts.size(); ++i) { m_nameStarts[i] -= length; }
+  
+  for (int i = index; i < static_cast<int>(m_entries.size()); ++i) {
+    if (!m_entries[i].id.isEmpty()) { m_idIndex[m_entries[i].id] = i; }
+  }
+  
+  // the trie and postings store indices too, they're patched in place rather
+  // than refolding every entry
+  m_words.removeEntry(index);
+  for (auto token = m_tokens.begin(); token != m_tokens.end();) {
+    std::vector<Posting>& postings = token->second;
+    postings.erase(std::remove_if(postings.begin(), postings.end(), [index](const Posting& posting) {
+      return posting.entry == index;
+    }), postings.end());
+    for (Posting& posting : postings) {
+      if (posting.entry > index) { --posting.entry; }
+    }
+    if (postings.empty()) {
+      token = m_tokens.erase(token);
+    } else {
+      ++token;
+    }
+  }
+  return true;
+}
+
+QString Catalog::fold(QStringView text, QByteArray* boundaries)
+{
+  // compatibility decomposition splits accents off (é -> e + ´) and maps
+  // full-width and ligature forms to plain ones; plain ascii is already there
+  QString decomposed;
+  bool ascii = std::all_of(text.begin(), text.end(), [](QChar c) { return c.unicode() < 0x80; });
+  if (!ascii) {
+    decomposed = text.toString().normalized(QString::NormalizationForm_KD);
+    text = decomposed;
+  }
+  
+  QString folded;
+  folded.reserve(text.size());
+  if (boundaries) {
+    boundaries->clear();
+    boundaries->reserve(text.size());
+  }
+  
+  bool pendingSpace = false;
+  QChar previous;
+  for (QChar c : text) {
+    // the split-off accents are dropped, so "cafe" finds "Café"
+    if (c.isMark()) continue;
+    
+    if (c.isSpace()) {
+      pendingSpace = !folded.isEmpty();
+      previous = c;
+      continue;
+    }
+    if (pendingSpace) {
+      folded.append(QChar(' '));
+      if (boundaries) { boundaries->append(FuzzyMatcher::NO_BOUNDARY); }
+      pendingSpace = false;
+    }
+    
+    if (boundaries) {
+      // computed on the original text, folding loses the case
+      FuzzyMatcher::Boundary boundary = FuzzyMatcher::NO_BOUNDARY;
+      if (previous.isNull() || !previous.isLetterOrNumber()) {
+        boundary = FuzzyMatcher::WORD_BOUNDARY;
+      } else if ((previous.isLower() && c.isUpper()) || (previous.isLetter() && c.isDigit())) {
+        boundary = FuzzyMatcher::CAMEL_BOUNDARY;
+      }
+      boundaries->append(boundary);
+    }
+    
+    folded.append(c.toCaseFolded());
+    previous = c;
+  }
+  
+  return folded;
+}
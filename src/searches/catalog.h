@@ -0,0 +1,112 @@
+#pragma once
+#include "wordtrie.h"
+#include <QString>
+#include <QStringView>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <map>
+#include <vector>
+
+struct CatalogEntry
+{
+  QString name;
+  QString localizedName;
+  QString genericName;
+  QString keywords; // ';' separated
+  QString description;
+  QString exec;
+  QString icon;
+  QString desktopDir; // directories are scanned flat, the file is desktopDir/id
+  QString id; // desktop file id, unique within a catalog
+  
+  QString desktopFile() const { return desktopDir.isEmpty() ? QString() : desktopDir + '/' + id; }
+};
+
+// searchable list of entries with match-ready text cached at load time
+//
+// what a full scan reads lives in flat arrays beside the entries: folded names
+// back to back in one string, their boundaries in one byte array and the masks
+// in another. the display strings that repeat across entries (directories,
+// icons, comments) are interned, so entries share one copy of each
+class Catalog
+{
+public:
+  // fields in the token index, a token hit scores its field's weight
+  enum Field : quint8 { NAME, LOCALIZED_NAME, GENERIC_NAME, KEYWORDS, COMMENT };
+  static constexpr int FIELD_WEIGHTS[] = {90, 85, 70, 65, 40};
+  static constexpr int PREFIX_PENALTY = 5; // token only starts with the query word
+  
+  struct Posting
+  {
+    int entry;
+    Field field;
+  };
+  
+  void clear();
+  void reserve(int size);
+  
+  // folds, tokenizes and interns the entry's fields and stores it, unless one
+  // with the same id is already there (the first one added wins)
+  bool append(CatalogEntry entry);
+  
+  // index of the entry with this desktop file id, or -1
+  int indexOfId(const QString& id) const { return m_idIndex.value(id, -1); }
+  
+  // drop the entry with this desktop file id, if any
+  bool removeId(const QString& id);
+  
+  const std::vector<CatalogEntry>& entries() const { return m_entries; }
+  
+  // normalized name, the other fields are only searched through the token index
+  QStringView foldedName(int index) const
+  { return QStringView(m_names).mid(m_nameStarts[index], m_nameStarts[index + 1] - m_nameStarts[index]); }
+  
+  // FuzzyMatcher::Boundary per char of foldedName(index)
+  QByteArrayView nameBoundaries(int index) const
+  { return QByteArrayView(m_nameBoundaries).mid(m_nameStarts[index], m_nameStarts[index + 1] - m_nameStarts[index]); }
+  
+  // prefilter mask per entry's folded name, contiguous for Prefilter
+  const std::vector<quint64>& masks() const { return m_masks; }
+  
+  // call visit(token, postings) for every indexed token starting with prefix
+  template <typename Visit>
+  void visitPrefix(const QString& prefix, Visit visit) const
+  {
+    for (auto it = m_tokens.lower_bound(prefix); it != m_tokens.end() && it->first.startsWith(prefix); ++it) {
+      visit(it->first, it->second);
+    }
+  }
+  
+  // words of every folded name, for typo-tolerant lookups
+  const WordTrie& words() const { return m_words; }
+  int size() const { return static_cast<int>(m_entries.size()); }
+  bool isEmpty() const { return m_entries.empty(); }
+  
+  // NFKD, strip diacritics, case fold and collapse whitespace (used for both
+  // entries and queries), optionally noting where words and camelCase humps start
+  static QString fold(QStringView text, QByteArray* boundaries = nullptr);
+  
+  // letter/digit runs of folded text, how both fields and queries are split
+  static QList<QStringView> tokens(QStringView folded);
+
+private:
+  // add entry's words to the trie and its tokens to m_tokens
+  void indexEntry(const CatalogEntry& entry, int index);
+  void indexField(QStringView text, int index, Field field);
+  
+  // the pooled copy of text, added if it's new
+  QString intern(const QString& text);
+  
+  std::vector<CatalogEntry> m_entries;
+  QString m_names; // every folded name, back to back
+  QByteArray m_nameBoundaries; // parallel to m_names
+  std::vector<quint32> m_nameStarts{0}; // entry i's name is [m_nameStarts[i], m_nameStarts[i + 1])
+  std::vector<quint64> m_masks;
+  QSet<QString> m_strings; // interned display strings
+  WordTrie m_words;
+  std::map<QString, std::vector<Posting>> m_tokens; // sorted, so prefixes are ranges
+  QHash<QString, int> m_idIndex; // id -> index into m_entries
+};
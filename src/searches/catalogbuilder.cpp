@@ -0,0 +1,197 @@
+#include "catalogbuilder.h"
+#include "desktopcache.h"
+#include "desktopsearch.h"
+#include "desktopwatcher.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+#include <QMetaObject>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <utility>
+
+CatalogBuilder::CatalogBuilder(QObject* parent) : QObject(parent) {}
+
+void CatalogBuilder::addView(DesktopSearch* view)
+{ m_views.push_back(view); }
+
+void CatalogBuilder::build()
+{ std::call_once(m_built, [this]() { run(); }); }
+
+void CatalogBuilder::run()
+{
+  struct Dir
+  {
+    QString path;
+    qint64 mtime = 0;
+    std::vector<DesktopCacheEntry> entries;
+    bool edited = false; // a file changed in place, the listing didn't
+  };
+  
+  // parsed entries from the last run, only changed files get parsed again
+  DesktopCache cache("desktop");
+  cache.load();
+  
+  // list every directory once; stale entries are left empty and parsed below
+  m_dirs = applicationDirectories();
+  std::vector<Dir> dirs;
+  std::vector<std::pair<size_t, size_t>> stale; // (dir, entry) still to parse
+  
+  for (const QString& dirPath : m_dirs) {
+    QFileInfo dirInfo(dirPath);
+    if (!dirInfo.isDir()) continue;
+    
+    // adding, removing or replacing a file bumps the directory mtime
+    Dir dir;
+    dir.path = dirPath;
+    dir.mtime = dirInfo.lastModified().toMSecsSinceEpoch();
+    dir.entries = cache.entries(dirPath);
+    
+    if (cache.isFresh(dirPath, dir.mtime)) {
+      // the same files as last time, but editing one in place leaves the
+      // directory mtime alone, so each is checked against its own
+      for (size_t i = 0; i < dir.entries.size(); ++i) {
+        DesktopCacheEntry& cached = dir.entries[i];
+        qint64 mtime = QFileInfo(cached.entry.file).lastModified().toMSecsSinceEpoch();
+        if (mtime == cached.mtime) continue;
+        
+        cached.mtime = mtime;
+        dir.edited = true;
+        stale.emplace_back(dirs.size(), i);
+      }
+    } else {
+      QHash<QString, DesktopCacheEntry> previous;
+      for (DesktopCacheEntry& cached : dir.entries) { previous.insert(cached.entry.file, std::move(cached)); }
+      dir.entries.clear();
+      
+      QFileInfoList files = QDir(dirPath).entryInfoList(QStringList() << "*.desktop", QDir::Files, QDir::Name);
+      
+      for (const QFileInfo& fileInfo : files) {
+        DesktopCacheEntry cached;
+        cached.mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+        cached.entry.file = fileInfo.absoluteFilePath();
+        
+        auto it = previous.find(cached.entry.file);
+        if (it != previous.end() && it->mtime == cached.mtime) {
+          cached = std::move(*it);
+        } else {
+          stale.emplace_back(dirs.size(), dir.entries.size());
+        }
+        dir.entries.push_back(std::move(cached));
+      }
+    }
+    dirs.push_back(std::move(dir));
+  }
+  
+  // XDG: the first directory holding an id wins, even if that copy is hidden
+  auto publishDirs = [&]() {
+    std::vector<const DesktopEntry*> entries;
+    QSet<QString> seen;
+    for (const Dir& dir : dirs) {
+      for (const DesktopCacheEntry& cached : dir.entries) {
+        QString id = cached.entry.id();
+        if (seen.contains(id)) continue;
+        
+        seen.insert(id);
+        entries.push_back(&cached.entry);
+      }
+    }
+    publish(entries);
+  };
+  
+  // what the cache already had is searchable while the rest is parsed
+  if (!stale.empty()) { publishDirs(); }
+  
+  // each task writes only its own slot, so the order stays the listing order
+  QThreadPool pool;
+  for (const auto& slot : stale) {
+    DesktopEntry* entry = &dirs[slot.first].entries[slot.second].entry;
+    pool.start([entry]() { *entry = DesktopEntry::parse(entry->file); });
+  }
+  pool.waitForDone();
+  
+  publishDirs();
+  
+  for (Dir& dir : dirs) { cache.store(dir.path, dir.mtime, std::move(dir.entries), dir.edited); }
+  cache.save();
+  
+  // from now on changes are patched in as they happen, on our own thread
+  QMetaObject::invokeMethod(this, [this]() { startWatching(); }, Qt::QueuedConnection);
+}
+
+void CatalogBuilder::publish(const std::vector<const DesktopEntry*>& entries)
+{
+  for (DesktopSearch* view : m_views) { view->setEntries(entries); }
+}
+
+void CatalogBuilder::startWatching()
+{
+  m_watcher = new DesktopWatcher(QStringList() << "*.desktop", this);
+  connect(m_watcher, &DesktopWatcher::filesChanged, this, &CatalogBuilder::applyChanges);
+  m_watcher->watch(m_dirs);
+}
+
+void CatalogBuilder::applyChanges(const QStringList& paths)
+{
+  QStringList removedIds;
+  std::vector<DesktopEntry> entries;
+  QSet<QString> handled;
+  
+  for (const QString& path : paths) {
+    QString id = path.mid(path.lastIndexOf('/') + 1);
+    if (handled.contains(id)) continue;
+    handled.insert(id);
+    
+    // whichever directory now holds the id first decides, same as the build
+    QString winner;
+    for (const QString& dir : m_dirs) {
+      QString candidate = dir + '/' + id;
+      if (QFileInfo::exists(candidate)) {
+        winner = candidate;
+        break;
+      }
+    }
+    
+    if (winner.isEmpty()) {
+      removedIds.append(id);
+    } else {
+      entries.push_back(DesktopEntry::parse(winner));
+    }
+  }
+  
+  for (DesktopSearch* view : m_views) { view->updateEntries(removedIds, entries); }
+}
+
+QStringList CatalogBuilder::applicationDirectories()
+{
+  QStringList dirs;
+  
+  // user-specific applications
+  QString userAppsDir = QStandardPaths::writableLocation(QStandardPaths::ApplicationsLocation);
+  if (!userAppsDir.isEmpty()) {
+    dirs.append(userAppsDir);
+  }
+  
+  // system-wide applications from XDG_DATA_DIRS
+  QStringList dataDirs = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
+  for (const QString& dir : dataDirs) {
+    if (!dirs.contains(dir)) {
+      dirs.append(dir);
+    }
+  }
+  
+  QStringList commonDirs = {
+    "/usr/share/applications",
+    "/usr/local/share/applications",
+    QDir::homePath() + "/.local/share/applications"
+  };
+  
+  for (const QString& dir : commonDirs) {
+    if (QDir(dir).exists() && !dirs.contains(dir)) {
+      dirs.append(dir);
+    }
+  }
+  
+  return dirs;
+}
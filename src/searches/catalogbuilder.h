@@ -0,0 +1,43 @@
+#pragma once
+#include "desktopentry.h"
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <mutex>
+#include <vector>
+
+class DesktopSearch;
+class DesktopWatcher;
+
+// lists every application directory once, parses what changed across a
+// thread pool and feeds the result to every desktop search (apps, settings)
+class CatalogBuilder : public QObject
+{
+  Q_OBJECT
+public:
+  explicit CatalogBuilder(QObject* parent = nullptr);
+  
+  // views are fed from the building thread, in the order they were added
+  void addView(DesktopSearch* view);
+  
+  // build once, a second caller blocks until the first one is done
+  void build();
+  
+  // XDG application directories, highest precedence first
+  static QStringList applicationDirectories();
+
+private:
+  void run();
+  
+  // hand each view the entries it accepts, entries are in precedence order
+  void publish(const std::vector<const DesktopEntry*>& entries);
+  
+  // after the build, patch the views as files come and go (ui thread)
+  void startWatching();
+  void applyChanges(const QStringList& paths);
+  
+  std::once_flag m_built;
+  std::vector<DesktopSearch*> m_views;
+  QStringList m_dirs; // written by run() before watching starts
+  DesktopWatcher* m_watcher = nullptr;
+};
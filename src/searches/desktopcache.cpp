@@ -0,0 +1,178 @@
+#include "desktopcache.h"
+#include "binaryio.h"
+#include <QByteArray>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <utility>
+
+namespace {
+
+constexpr quint32 MAGIC = 0x43445053; // "SPDC"
+constexpr quint32 VERSION = 4;
+
+// entry flags
+constexpr quint32 HIDDEN = 1;
+constexpr quint32 NO_DISPLAY = 2;
+
+// layout (see binaryio.h for str):
+//   header  u32 magic, u32 version, u32 dir count, u32 reserved, str locale
+//   dir     i64 mtime, u32 entry count, str path, then its entries
+//   entry   i64 mtime, u32 flags, str file, str name, str localized name,
+//           str generic name, str keywords, str description, str exec, str icon
+
+DesktopCacheEntry readEntry(BinaryReader& reader)
+{
+  DesktopCacheEntry cached;
+  cached.mtime = reader.read<qint64>();
+  quint32 flags = reader.read<quint32>();
+  cached.entry.hidden = flags & HIDDEN;
+  cached.entry.noDisplay = flags & NO_DISPLAY;
+  cached.entry.file = reader.readString();
+  cached.entry.name = reader.readString();
+  cached.entry.localizedName = reader.readString();
+  cached.entry.genericName = reader.readString();
+  cached.entry.keywords = reader.readString();
+  cached.entry.description = reader.readString();
+  cached.entry.exec = reader.readString();
+  cached.entry.icon = reader.readString();
+  return cached;
+}
+
+} // namespace
+
+DesktopCache::DesktopCache(const QString& name)
+{
+  m_path = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+           "/spotlight/" + name + ".cache";
+}
+
+DesktopCache::~DesktopCache()
+{ unmap(); }
+
+bool DesktopCache::load()
+{
+  unmap();
+  
+  m_file.setFileName(m_path);
+  if (!m_file.open(QIODevice::ReadOnly)) return false;
+  
+  m_size = m_file.size();
+  m_data = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+  if (!m_data || !index()) {
+    unmap();
+    return false;
+  }
+  return true;
+}
+
+bool DesktopCache::index()
+{
+  BinaryReader reader{m_data, m_size};
+  if (reader.read<quint32>() != MAGIC || reader.read<quint32>() != VERSION) return false;
+  
+  quint32 dirCount = reader.read<quint32>();
+  reader.read<quint32>();
+  
+  // localized names were picked for the locale then, none of them can be reused
+  if (reader.readString() != DesktopEntry::locale()) return false;
+  
+  // only the directories are indexed, entries are decoded when asked for
+  for (quint32 i = 0; i < dirCount && reader.ok; ++i) {
+    MappedDir dir;
+    dir.mtime = reader.read<qint64>();
+    dir.count = reader.read<quint32>();
+    QString path = reader.readString();
+    dir.offset = reader.pos;
+    
+    for (quint32 j = 0; j < dir.count && reader.ok; ++j) {
+      reader.read<qint64>();
+      reader.read<quint32>();
+      for (int field = 0; field < 8; ++field) { reader.skipString(); }
+    }
+    m_mapped.insert(path, dir);
+  }
+  
+  return reader.ok;
+}
+
+void DesktopCache::unmap()
+{
+  if (m_data) { m_file.unmap(const_cast<uchar*>(m_data)); }
+  m_file.close();
+  m_data = nullptr;
+  m_size = 0;
+  m_mapped.clear();
+}
+
+bool DesktopCache::isFresh(const QString& dir, qint64 mtime) const
+{
+  auto it = m_mapped.constFind(dir);
+  return it != m_mapped.constEnd() && it->mtime == mtime;
+}
+
+std::vector<DesktopCacheEntry> DesktopCache::entries(const QString& dir) const
+{
+  std::vector<DesktopCacheEntry> result;
+  
+  auto it = m_mapped.constFind(dir);
+  if (it == m_mapped.constEnd()) return result;
+  
+  BinaryReader reader{m_data, m_size, it->offset};
+  result.reserve(it->count);
+  for (quint32 i = 0; i < it->count; ++i) { result.push_back(readEntry(reader)); }
+  
+  // index() walked this range already, so this only trips on a truncated file
+  if (!reader.ok) { result.clear(); }
+  return result;
+}
+
+void DesktopCache::store(const QString& dir, qint64 mtime, std::vector<DesktopCacheEntry> entries, bool edited)
+{
+  if (edited || !isFresh(dir, mtime)) { m_dirty = true; }
+  m_stored.push_back({dir, mtime, std::move(entries)});
+}
+
+bool DesktopCache::save()
+{
+  // a directory that disappeared also needs a rewrite
+  if (!m_dirty && m_stored.size() == static_cast<size_t>(m_mapped.size())) return true;
+  
+  QByteArray out;
+  writeValue<quint32>(out, MAGIC);
+  writeValue<quint32>(out, VERSION);
+  writeValue<quint32>(out, static_cast<quint32>(m_stored.size()));
+  writeValue<quint32>(out, 0);
+  writeString(out, DesktopEntry::locale());
+  
+  for (const StoredDir& dir : m_stored) {
+    writeValue<qint64>(out, dir.mtime);
+    writeValue<quint32>(out, static_cast<quint32>(dir.entries.size()));
+    writeString(out, dir.path);
+    
+    for (const DesktopCacheEntry& cached : dir.entries) {
+      const DesktopEntry& entry = cached.entry;
+      writeValue<qint64>(out, cached.mtime);
+      writeValue<quint32>(out, (entry.hidden ? HIDDEN : 0) | (entry.noDisplay ? NO_DISPLAY : 0));
+      writeString(out, entry.file);
+      writeString(out, entry.name);
+      writeString(out, entry.localizedName);
+      writeString(out, entry.genericName);
+      writeString(out, entry.keywords);
+      writeString(out, entry.description);
+      writeString(out, entry.exec);
+      writeString(out, entry.icon);
+    }
+  }
+  
+  QDir().mkpath(QFileInfo(m_path).absolutePath());
+  
+  QSaveFile file(m_path);
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  file.write(out);
+  if (!file.commit()) return false;
+  
+  m_dirty = false;
+  return true;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "desktopentry.h"
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QFile>
+#include <vector>
+
+// one parsed .desktop file as stored in the cache, hidden and unlisted
+// files are kept too so they don't get reparsed
+struct DesktopCacheEntry
+{
+  qint64 mtime = 0;
+  DesktopEntry entry;
+};
+
+// parsed desktop entries persisted under $XDG_CACHE_HOME/spotlight/<name>.cache
+//
+// entries are grouped by directory and each is reused while its file mtime
+// still matches; the directory mtime only tells whether files were added or
+// removed, so an unchanged directory isn't listed again. a cache written under
+// another locale is ignored, its localized names would be stale
+class DesktopCache
+{
+public:
+  explicit DesktopCache(const QString& name);
+  ~DesktopCache();
+  
+  // map the cache file, returns false (and acts empty) if missing or invalid
+  bool load();
+  
+  // true if dir was cached with this mtime, so it holds the same files
+  bool isFresh(const QString& dir, qint64 mtime) const;
+  
+  // entries cached for dir, empty if it wasn't cached
+  std::vector<DesktopCacheEntry> entries(const QString& dir) const;
+  
+  // record what dir holds now, in the order dirs should be written; edited
+  // if a file was reparsed although the directory is fresh
+  void store(const QString& dir, qint64 mtime, std::vector<DesktopCacheEntry> entries, bool edited);
+  
+  // write the stored dirs back, skipped when nothing changed since load
+  bool save();
+
+private:
+  struct MappedDir
+  {
+    qint64 mtime = 0;
+    quint32 count = 0;
+    qint64 offset = 0; // of the first entry
+  };
+  
+  struct StoredDir
+  {
+    QString path;
+    qint64 mtime = 0;
+    std::vector<DesktopCacheEntry> entries;
+  };
+  
+  void unmap();
+  bool index();
+  
+  QString m_path;
+  QFile m_file;
+  const uchar* m_data = nullptr;
+  qint64 m_size = 0;
+  QHash<QString, MappedDir> m_mapped;
+  
+  std::vector<StoredDir> m_stored;
+  bool m_dirty = false;
+};
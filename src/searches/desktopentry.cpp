@@ -0,0 +1,101 @@
+#include "desktopentry.h"
+#include <QFile>
+#include <QLocale>
+#include <string>
+#include <string_view>
+
+namespace {
+
+std::string_view trimmed(std::string_view text)
+{
+  auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+  while (!text.empty() && isSpace(text.front())) { text.remove_prefix(1); }
+  while (!text.empty() && isSpace(text.back())) { text.remove_suffix(1); }
+  return text;
+}
+
+QString toString(std::string_view text)
+{ return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size())); }
+
+// Name[de_DE] beats Name[de], per the spec's locale matching
+struct LocaleKeys
+{
+  std::string country;
+  std::string language;
+};
+
+const LocaleKeys& localeKeys()
+{
+  static const LocaleKeys keys = []() {
+    const QString locale = DesktopEntry::locale();
+    LocaleKeys built;
+    built.country = "Name[" + locale.toStdString() + "]";
+    built.language = "Name[" + locale.left(locale.indexOf('_')).toStdString() + "]";
+    return built;
+  }();
+  return keys;
+}
+
+} // namespace
+
+QString DesktopEntry::locale()
+{ return QLocale::system().name(); }
+
+DesktopEntry DesktopEntry::parse(const QString& filePath)
+{
+  DesktopEntry entry;
+  entry.file = filePath;
+  
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) return entry;
+  
+  const qint64 size = file.size();
+  uchar* data = size > 0 ? file.map(0, size) : nullptr;
+  if (!data) return entry;
+  
+  std::string_view rest(reinterpret_cast<const char*>(data), static_cast<size_t>(size));
+  bool inDesktopEntry = false;
+  bool countryMatched = false;
+  const LocaleKeys& locale = localeKeys();
+  
+  while (!rest.empty()) {
+    size_t newline = rest.find('\n');
+    std::string_view line = trimmed(rest.substr(0, newline));
+    rest.remove_prefix(newline == std::string_view::npos ? rest.size() : newline + 1);
+    
+    if (line.empty() || line.front() == '#') continue;
+    
+    if (line.front() == '[' && line.back() == ']') {
+      // everything we need is in this one group
+      if (inDesktopEntry) break;
+      inDesktopEntry = (line == "[Desktop Entry]");
+      continue;
+    }
+    
+    if (!inDesktopEntry) continue;
+    
+    size_t eqPos = line.find('=');
+    if (eqPos == std::string_view::npos) continue;
+    
+    std::string_view key = trimmed(line.substr(0, eqPos));
+    std::string_view value = trimmed(line.substr(eqPos + 1));
+    
+    // other localized keys (Comment[de]=...) never compare equal, so they're skipped
+    if (key == "Name") { if (entry.name.isEmpty()) entry.name = toString(value); }
+    else if (key == locale.country) {
+      entry.localizedName = toString(value);
+      countryMatched = true;
+    }
+    else if (key == locale.language) { if (!countryMatched) entry.localizedName = toString(value); }
+    else if (key == "GenericName") { entry.genericName = toString(value); }
+    else if (key == "Keywords") { entry.keywords = toString(value); }
+    else if (key == "Comment") { if (entry.description.isEmpty()) entry.description = toString(value); }
+    else if (key == "Exec") { entry.exec = toString(value); }
+    else if (key == "Icon") { entry.icon = toString(value); }
+    else if (key == "Hidden") { entry.hidden = (value == "true"); }
+    else if (key == "NoDisplay") { entry.noDisplay = (value == "true"); }
+  }
+  
+  file.unmap(data);
+  return entry;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <QString>
+
+// the [Desktop Entry] keys the searches care about
+struct DesktopEntry
+{
+  QString file; // absolute path it was parsed from
+  QString name;
+  QString localizedName; // Name[xx] for the user's locale, if there is one
+  QString genericName;
+  QString keywords; // ';' separated, as in the file
+  QString description; // Comment
+  QString exec;
+  QString icon;
+  bool hidden = false;
+  bool noDisplay = false;
+  
+  // map filePath and scan it in place, strings are only built for the keys
+  // above and nothing after the [Desktop Entry] group is read
+  static DesktopEntry parse(const QString& filePath);
+  
+  // the locale localizedName is picked for, e.g. de_DE
+  static QString locale();
+  
+  // desktop file id, directories are scanned flat so it's just the file name
+  QString id() const { return file.mid(file.lastIndexOf('/') + 1); }
+};
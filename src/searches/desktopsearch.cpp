@@ -0,0 +1,65 @@
+#include "desktopsearch.h"
+#include "catalogbuilder.h"
+#include <memory>
+#include <utility>
+
+DesktopSearch::DesktopSearch(CatalogBuilder* builder, QObject* parent)
+  : Search(parent), m_builder(builder)
+{ m_builder->addView(this); }
+
+ResultList DesktopSearch::performSearch(const QString& query)
+{
+  if (query.isEmpty()) {
+    // don't return results for no query
+    return {};
+  }
+  
+  // fold once per query, entries were folded at load time
+  return searchCatalog(catalog(), Catalog::fold(query));
+}
+
+void DesktopSearch::load()
+{ m_builder->build(); }
+
+void DesktopSearch::setEntries(const std::vector<const DesktopEntry*>& entries)
+{
+  Catalog catalog;
+  catalog.reserve(static_cast<int>(entries.size()));
+  
+  // entries come deduplicated by id already, so same-named apps both stay
+  for (const DesktopEntry* entry : entries) {
+    if (accepts(*entry)) { catalog.append(toCatalogEntry(*entry)); }
+  }
+  
+  publishCatalog(std::make_shared<const Catalog>(std::move(catalog)));
+}
+
+void DesktopSearch::updateEntries(const QStringList& removedIds, const std::vector<DesktopEntry>& entries)
+{
+  // copy the current snapshot and patch only what changed
+  std::shared_ptr<const Catalog> current = catalog();
+  Catalog updated = current ? *current : Catalog();
+  
+  for (const QString& id : removedIds) { updated.removeId(id); }
+  for (const DesktopEntry& entry : entries) {
+    updated.removeId(entry.id());
+    if (accepts(entry)) { updated.append(toCatalogEntry(entry)); }
+  }
+  
+  publishCatalog(std::make_shared<const Catalog>(std::move(updated)));
+}
+
+CatalogEntry DesktopSearch::toCatalogEntry(const DesktopEntry& entry)
+{
+  CatalogEntry catalogEntry;
+  catalogEntry.name = entry.name;
+  catalogEntry.localizedName = entry.localizedName;
+  catalogEntry.genericName = entry.genericName;
+  catalogEntry.keywords = entry.keywords;
+  catalogEntry.description = entry.description;
+  catalogEntry.exec = entry.exec;
+  catalogEntry.icon = entry.icon;
+  catalogEntry.desktopDir = entry.file.left(entry.file.lastIndexOf('/'));
+  catalogEntry.id = entry.id();
+  return catalogEntry;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "searches.h"
+#include "desktopentry.h"
+#include "catalog.h"
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+class CatalogBuilder;
+
+// search over the desktop entries CatalogBuilder finds, subclasses only
+// decide which entries they list
+class DesktopSearch : public Search
+{
+  Q_OBJECT
+public:
+  explicit DesktopSearch(CatalogBuilder* builder, QObject* parent = nullptr);
+  
+  ResultList performSearch(const QString& query) override;
+  void load() override;
+  
+  // called from the building thread, so must not touch any state
+  virtual bool accepts(const DesktopEntry& entry) const = 0;
+  
+  // replace the catalog with the accepted entries, in precedence order
+  void setEntries(const std::vector<const DesktopEntry*>& entries);
+  
+  // drop removedIds and whatever entries replace, then add accepted entries
+  void updateEntries(const QStringList& removedIds, const std::vector<DesktopEntry>& entries);
+
+private:
+  static CatalogEntry toCatalogEntry(const DesktopEntry& entry);
+  
+  CatalogBuilder* m_builder = nullptr;
+};
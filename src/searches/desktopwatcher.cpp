@@ -0,0 +1,145 @@
+#include "desktopwatcher.h"
+#include <QDir>
+#include <QFile>
+#include <QSocketNotifier>
+#include <QFileInfo>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+
+// close-write for edits in place, moves for atomic replaces, create for
+// symlinks (flatpak exports) which never get a close-write
+constexpr uint32_t DIR_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+// added onto whatever else watches the same directory
+constexpr uint32_t PARENT_MASK = IN_CREATE | IN_MOVED_TO | IN_ONLYDIR | IN_MASK_ADD;
+
+} // namespace
+
+DesktopWatcher::DesktopWatcher(const QStringList& nameFilters, QObject* parent)
+  : QObject(parent), m_nameFilters(nameFilters)
+{
+  m_settleTimer.setSingleShot(true);
+  m_settleTimer.setInterval(SETTLE_MS);
+  connect(&m_settleTimer, &QTimer::timeout, this, &DesktopWatcher::flush);
+}
+
+DesktopWatcher::~DesktopWatcher()
+{
+  // closing the descriptor drops every watch with it
+  if (m_fd >= 0) { ::close(m_fd); }
+}
+
+bool DesktopWatcher::watch(const QStringList& dirs)
+{
+  if (m_fd < 0) {
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) return false;
+    
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, [this]() { readEvents(); });
+  }
+  
+  for (const QString& dir : dirs) {
+    int wd = inotify_add_watch(m_fd, QFile::encodeName(dir).constData(), DIR_MASK);
+    if (wd >= 0) {
+      m_dirs.insert(wd, dir);
+    } else {
+      // the user flatpak exports only appear with the first user install
+      m_missing.append(dir);
+    }
+  }
+  if (!m_missing.isEmpty()) { watchMissing(); }
+  return true;
+}
+
+void DesktopWatcher::watchMissing()
+{
+  // the old ancestors may have been passed, they're watched again below
+  for (auto it = m_parents.constBegin(); it != m_parents.constEnd(); ++it) {
+    if (!m_dirs.contains(it.key())) { inotify_rm_watch(m_fd, it.key()); }
+  }
+  m_parents.clear();
+  
+  QStringList missing;
+  for (const QString& dir : m_missing) {
+    int wd = inotify_add_watch(m_fd, QFile::encodeName(dir).constData(), DIR_MASK);
+    if (wd >= 0) {
+      m_dirs.insert(wd, dir);
+      
+      // files can land before the watch does, an install creates the
+      // directory and its entries together
+      for (const QString& name : QDir(dir).entryList(m_nameFilters, QDir::Files)) { m_pending.insert(dir + '/' + name); }
+      continue;
+    }
+    missing.append(dir);
+    
+    // one level at a time: each directory created on the way moves this down
+    QString parent = dir;
+    int parentWd = -1;
+    do {
+      parent = QFileInfo(parent).path();
+      parentWd = inotify_add_watch(m_fd, QFile::encodeName(parent).constData(), PARENT_MASK);
+    } while (parentWd < 0 && parent.size() > 1);
+    if (parentWd >= 0) { m_parents.insert(parentWd, parent); }
+  }
+  m_missing = missing;
+  
+  if (!m_pending.isEmpty()) { m_settleTimer.start(); }
+}
+
+void DesktopWatcher::readEvents()
+{
+  alignas(struct inotify_event) char buffer[4096];
+  bool created = false; // a directory appeared on the way to a missing one
+  
+  for (;;) {
+    ssize_t length = ::read(m_fd, buffer, sizeof(buffer));
+    if (length <= 0) break; // EAGAIN once drained
+    
+    for (char* ptr = buffer; ptr < buffer + length;) {
+      auto* event = reinterpret_cast<struct inotify_event*>(ptr);
+      ptr += sizeof(struct inotify_event) + event->len;
+      
+      // a watched directory that's deleted is waited for like a missing one
+      if (event->mask & IN_IGNORED) {
+        const QString dir = m_dirs.take(event->wd);
+        if (!dir.isEmpty()) {
+          m_missing.append(dir);
+          created = true;
+        }
+        continue;
+      }
+      
+      if (event->mask & IN_ISDIR) {
+        if (m_parents.contains(event->wd)) { created = true; }
+        continue;
+      }
+      if (event->len == 0) continue;
+      
+      auto it = m_dirs.constFind(event->wd);
+      if (it == m_dirs.constEnd()) continue;
+      
+      QString name = QFile::decodeName(event->name);
+      if (!QDir::match(m_nameFilters, name)) continue;
+      
+      m_pending.insert(*it + '/' + name);
+    }
+  }
+  
+  if (created) { watchMissing(); }
+  
+  // restarted on every event, so a burst is reported once it settles
+  if (!m_pending.isEmpty()) { m_settleTimer.start(); }
+}
+
+void DesktopWatcher::flush()
+{
+  QStringList paths(m_pending.begin(), m_pending.end());
+  m_pending.clear();
+  
+  // sorted so a batch is applied the same way every time
+  paths.sort();
+  emit filesChanged(paths);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+
+class QSocketNotifier;
+
+// watches directories with inotify and reports desktop files that were
+// added, modified or removed, so a catalog can be patched instead of rebuilt
+class DesktopWatcher : public QObject
+{
+  Q_OBJECT
+public:
+  // package installs touch many files at once, they're reported in one batch
+  static constexpr int SETTLE_MS = 150;
+  
+  // only file names matching nameFilters (QDir wildcards) are reported
+  explicit DesktopWatcher(const QStringList& nameFilters, QObject* parent = nullptr);
+  ~DesktopWatcher() override;
+  
+  // start watching dirs, returns false without inotify; a missing one is
+  // watched from when it's created, with the files it already holds reported
+  bool watch(const QStringList& dirs);
+
+signals:
+  // absolute paths that changed in any way, check whether each still exists
+  void filesChanged(const QStringList& paths);
+
+private:
+  void readEvents();
+  void flush();
+  
+  // watch whichever missing dirs exist by now, and the nearest existing
+  // ancestor of the rest
+  void watchMissing();
+  
+  int m_fd = -1;
+  QSocketNotifier* m_notifier = nullptr;
+  QHash<int, QString> m_dirs; // watch descriptor -> directory
+  QStringList m_missing; // dirs to watch once they exist
+  QHash<int, QString> m_parents; // watch descriptor -> ancestor of a missing dir
+  QStringList m_nameFilters;
+  
+  QSet<QString> m_pending;
+  QTimer m_settleTimer;
+};
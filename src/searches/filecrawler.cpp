@@ -0,0 +1,132 @@
+#include "filecrawler.h"
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// linux_dirent64 as getdents64 fills the buffer: u64 inode, i64 offset,
+// u16 record length, u8 type, then the NUL-terminated name
+constexpr size_t DIRENT_LENGTH = 16;
+constexpr size_t DIRENT_TYPE = 18;
+constexpr size_t DIRENT_NAME = 19;
+
+constexpr size_t BUFFER_SIZE = 32 * 1024;
+
+} // namespace
+
+FileCrawler::FileCrawler(const QStringList& roots, const QStringList& excludes)
+{
+  for (const QString& root : roots) { m_roots.append(QFile::encodeName(QDir::cleanPath(root))); }
+  for (const QString& exclude : excludes) {
+    if (exclude.contains('/')) {
+      m_excludedPaths.insert(QFile::encodeName(QDir::cleanPath(exclude)));
+    } else {
+      m_excludedNames.insert(QFile::encodeName(exclude));
+    }
+  }
+}
+
+FileCrawler::Result FileCrawler::crawl(const std::atomic<bool>& cancelled)
+{
+  m_result = Result();
+  m_cancelled = &cancelled;
+  
+  // roots go in before any task runs, so they need no lock
+  for (const QByteArray& root : m_roots) {
+    m_result.dirs.push_back({NO_PARENT, static_cast<quint32>(m_result.names.size()), true});
+    m_result.names.append(root.constData(), root.size() + 1);
+  }
+  for (int i = 0; i < m_roots.size(); ++i) {
+    const QByteArray root = m_roots[i];
+    m_pool.start([this, i, root]() { walk(static_cast<quint32>(i), root); });
+  }
+  
+  // tasks queue their subdirectories, so this waits for the whole tree
+  m_pool.waitForDone();
+  m_cancelled = nullptr;
+  return std::move(m_result);
+}
+
+void FileCrawler::walk(quint32 dir, const QByteArray& path)
+{
+  if (m_cancelled->load()) return;
+  
+  // a root may be a link to another drive (the roots are the first dirs);
+  // below it links aren't followed, so the crawl can't loop
+  const int follow = dir < static_cast<quint32>(m_roots.size()) ? 0 : O_NOFOLLOW;
+  int fd = ::openat(AT_FDCWD, path.constData(), O_RDONLY | O_DIRECTORY | follow | O_CLOEXEC);
+  if (fd < 0) return;
+  
+  // gathered here, so the lock is taken once per directory
+  struct Found
+  {
+    quint32 name; // offset into names
+    bool directory;
+  };
+  QByteArray names;
+  std::vector<Found> found;
+  
+  char buffer[BUFFER_SIZE];
+  for (;;) {
+    const long bytes = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+    if (bytes <= 0) break;
+    
+    for (long pos = 0; pos < bytes;) {
+      const char* record = buffer + pos;
+      quint16 length = 0;
+      std::memcpy(&length, record + DIRENT_LENGTH, sizeof(length));
+      unsigned char type = static_cast<unsigned char>(record[DIRENT_TYPE]);
+      const char* name = record + DIRENT_NAME;
+      pos += length;
+      
+      // hidden entries, and . and .. with them
+      if (name[0] == '.') continue;
+      
+      // some filesystems leave the type to a stat
+      if (type == DT_UNKNOWN) {
+        struct stat info;
+        if (::fstatat(fd, name, &info, AT_SYMLINK_NOFOLLOW) != 0) continue;
+        type = S_ISDIR(info.st_mode) ? DT_DIR : DT_REG;
+      }
+      
+      const bool directory = type == DT_DIR;
+      if (directory && m_excludedNames.contains(QByteArray(name))) continue;
+      
+      found.push_back({static_cast<quint32>(names.size()), directory});
+      names.append(name, static_cast<qsizetype>(std::strlen(name)) + 1);
+    }
+  }
+  ::close(fd);
+  
+  const QByteArray prefix = path.endsWith('/') ? path : path + '/';
+  std::vector<std::pair<quint32, QByteArray>> subdirs;
+  {
+    QMutexLocker locker(&m_mutex);
+    const quint32 base = static_cast<quint32>(m_result.names.size());
+    m_result.names += names;
+    for (const Found& entry : found) {
+      if (entry.directory) {
+        QByteArray child = prefix + (names.constData() + entry.name);
+        if (m_excludedPaths.contains(child)) continue;
+        
+        subdirs.emplace_back(static_cast<quint32>(m_result.dirs.size()), std::move(child));
+        m_result.dirs.push_back({dir, base + entry.name, true});
+      }
+      m_result.files.push_back({dir, base + entry.name, entry.directory});
+    }
+  }
+  
+  for (const auto& subdir : subdirs) {
+    const quint32 index = subdir.first;
+    const QByteArray child = subdir.second;
+    m_pool.start([this, index, child]() { walk(index, child); });
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <vector>
+
+// walks directory trees across a thread pool, a task per directory reading
+// it with openat and getdents64; symlinks below the roots aren't followed
+// and hidden or excluded directories aren't entered
+class FileCrawler
+{
+public:
+  static constexpr quint32 NO_PARENT = 0xffffffff;
+  
+  // a directory or file by the directory it's in and where its name starts
+  struct Entry
+  {
+    quint32 parent; // index into dirs, NO_PARENT for a root
+    quint32 name; // offset into names
+    bool directory;
+  };
+  
+  struct Result
+  {
+    QByteArray names; // NUL-terminated, as the filesystem has them; roots are full paths
+    std::vector<Entry> dirs; // every directory walked, roots first, parents before children
+    std::vector<Entry> files; // everything found below the roots, directories too
+  };
+  
+  // an exclude with a slash is an absolute path, any other is a directory
+  // name skipped wherever it turns up
+  FileCrawler(const QStringList& roots, const QStringList& excludes);
+  
+  // walk every root; stops early, with whatever was found, once cancelled is set
+  Result crawl(const std::atomic<bool>& cancelled);
+
+private:
+  void walk(quint32 dir, const QByteArray& path);
+  
+  QList<QByteArray> m_roots;
+  QSet<QByteArray> m_excludedNames;
+  QSet<QByteArray> m_excludedPaths;
+  
+  // state of the running crawl, m_result is guarded by m_mutex
+  QThreadPool m_pool;
+  QMutex m_mutex;
+  Result m_result;
+  const std::atomic<bool>* m_cancelled = nullptr;
+};
@@ -0,0 +1,287 @@
+#include "files.h"
+#include "catalog.h"
+#include "filecrawler.h"
+#include "fuzzy.h"
+#include "prefilter.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+constexpr const char* INDEX_NAME = "files";
+
+// hidden directories are always skipped, these are skipped on top
+const QStringList DEFAULT_EXCLUDES = {"node_modules", "__pycache__"};
+
+// letters and digits, and anything non-ascii, which is most likely a letter
+bool isWordChar(char c)
+{ return static_cast<uchar>(c) >= 0x80 || std::isalnum(static_cast<uchar>(c)); }
+
+// "~/..." in the config file
+QString expandHome(const QString& path)
+{ return path == "~" || path.startsWith("~/") ? QDir::homePath() + path.mid(1) : path; }
+
+// the directory shown under a row's name, home as ~
+QString displayDir(const QString& dir)
+{
+  const QString home = QDir::homePath();
+  if (dir == home) return "~";
+  if (dir.startsWith(home + '/')) return '~' + dir.mid(home.size());
+  return dir;
+}
+
+// an Exec= line opening path with the default app, quoted per the desktop
+// entry spec; Launcher undoes the string escapes, then the quoting
+QString openCommand(const QString& path)
+{
+  QString quoted;
+  quoted.reserve(path.size() + 2);
+  for (QChar c : path) {
+    if (c == '"' || c == '`' || c == '$' || c == '\\') { quoted.append('\\'); }
+    quoted.append(c);
+  }
+  quoted.replace('\\', "\\\\");
+  quoted.replace('%', "%%");
+  return "xdg-open \"" + quoted + '"';
+}
+
+} // namespace
+
+FilesSearch::FilesSearch(QObject* parent) : Search(parent)
+{ readConfig(); }
+
+FilesSearch::~FilesSearch()
+{
+  // a crawl can take a while, it's abandoned rather than waited out
+  m_cancelled = true;
+  m_crawlPool.waitForDone();
+}
+
+void FilesSearch::readConfig()
+{
+  m_excludes = DEFAULT_EXCLUDES;
+  
+  QFile config(QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) + "/spotlight/files.conf");
+  if (config.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    QTextStream stream(&config);
+    QString line;
+    while (stream.readLineInto(&line)) {
+      line = line.trimmed();
+      if (line.isEmpty() || line.startsWith('#')) continue;
+      
+      if (line.startsWith('!')) {
+        m_excludes.append(expandHome(line.mid(1).trimmed()));
+      } else {
+        m_roots.append(QDir::cleanPath(expandHome(line)));
+      }
+    }
+  }
+  
+  if (m_roots.isEmpty()) { m_roots.append(QDir::cleanPath(QDir::homePath())); }
+}
+
+void FilesSearch::load()
+{
+  // the last crawl is searchable right away, however many files it holds
+  auto mapped = std::make_shared<PathIndex>(INDEX_NAME);
+  const bool loaded = mapped->load();
+  if (loaded) { publishIndex(mapped); }
+  
+  const qint64 age = QDateTime::currentSecsSinceEpoch() - mapped->crawledAt();
+  const bool reconfigured = mapped->roots() != m_roots || !mapped->hasExcludes(m_excludes);
+  if (!loaded || reconfigured || age > REFRESH_AFTER_SECS) { startCrawl(); }
+}
+
+void FilesSearch::startCrawl()
+{
+  // one at a time, and not over and over when the index can't be written
+  if (m_crawling.exchange(true)) return;
+  
+  const qint64 now = QDateTime::currentSecsSinceEpoch();
+  if (m_crawlStarted != 0 && now - m_crawlStarted < REFRESH_AFTER_SECS) {
+    m_crawling = false;
+    return;
+  }
+  m_crawlStarted = now;
+  
+  m_crawlPool.start([this]() {
+    crawl();
+    m_crawling = false;
+  });
+}
+
+void FilesSearch::crawl()
+{
+  FileCrawler crawler(m_roots, m_excludes);
+  const FileCrawler::Result result = crawler.crawl(m_cancelled);
+  if (m_cancelled) return;
+  
+  // searched from the file just written, the same way the next start will
+  auto fresh = std::make_shared<PathIndex>(INDEX_NAME);
+  if (fresh->save(result, m_excludes) && fresh->load()) { publishIndex(std::move(fresh)); }
+}
+
+std::shared_ptr<const PathIndex> FilesSearch::index() const
+{
+  QMutexLocker locker(&m_indexMutex);
+  return m_index;
+}
+
+void FilesSearch::publishIndex(std::shared_ptr<const PathIndex> index)
+{
+  {
+    QMutexLocker locker(&m_indexMutex);
+    m_index = std::move(index);
+  }
+  emit catalogChanged();
+}
+
+ResultList FilesSearch::performSearch(const QString& query)
+{
+  ResultList results;
+  std::shared_ptr<const PathIndex> current = index();
+  const QString foldedQuery = Catalog::fold(query);
+  if (!current || foldedQuery.isEmpty()) return results;
+  
+  // a resident instance may never load again, so it refreshes from here
+  if (QDateTime::currentSecsSinceEpoch() - current->crawledAt() > REFRESH_AFTER_SECS) { startCrawl(); }
+  
+  // names are matched as folded utf-8, every query word as a substring
+  std::vector<QByteArray> words;
+  quint64 queryMask = 0;
+  for (QStringView word : Catalog::tokens(foldedQuery)) {
+    words.push_back(word.toUtf8());
+    queryMask |= FuzzyMatcher::charMask(word);
+  }
+  if (words.empty()) return results;
+  
+  std::vector<Match> matches;
+  if (words.size() == 1 && words[0].size() < MIN_SCAN_LENGTH) {
+    // a letter or two would match most of the disk, only name prefixes count
+    prefixMatches(*current, words[0], matches);
+    m_lastQuery.clear();
+  } else {
+    // each word of an extended query contains one of the last query's, so
+    // its matches are a subset of the last ones on the same index
+    bool narrowing = current == m_lastIndex && !m_lastQuery.isEmpty() && foldedQuery.startsWith(m_lastQuery);
+    if (narrowing) {
+      for (quint32 file : m_lastMatches) {
+        const int score = scoreName(current->text(current->files()[file].folded), words);
+        if (score > 0) { matches.push_back({score, file}); }
+      }
+    } else {
+      scan(*current, words, queryMask, matches);
+    }
+    
+    m_lastIndex = current;
+    m_lastQuery = foldedQuery;
+    m_lastMatches.clear();
+    m_lastMatches.reserve(matches.size());
+    for (const Match& match : matches) { m_lastMatches.push_back(match.file); }
+  }
+  
+  // the table is in name order, so ties keep it
+  const size_t keep = qMin(matches.size(), static_cast<size_t>(MAX_RESULTS));
+  std::partial_sort(matches.begin(), matches.begin() + keep, matches.end(), [](const Match& a, const Match& b) {
+    return a.score != b.score ? a.score > b.score : a.file < b.file;
+  });
+  
+  // only the shown rows become entries, in a catalog that lives as long as they do
+  auto catalog = std::make_shared<Catalog>();
+  catalog->reserve(static_cast<int>(keep));
+  for (size_t i = 0; i < keep; ++i) {
+    const PathIndex::File& file = current->files()[matches[i].file];
+    
+    CatalogEntry entry;
+    entry.id = current->filePath(matches[i].file);
+    entry.name = QFile::decodeName(current->text(file.name));
+    entry.description = displayDir(current->dirPath(file.dir));
+    entry.exec = openCommand(entry.id);
+    if (catalog->append(std::move(entry))) {
+      results.results.push_back({catalog.get(), catalog->size() - 1, matches[i].score - FILE_PENALTY});
+    }
+  }
+  if (!results.empty()) { results.keep(catalog); }
+  
+  return results;
+}
+
+void FilesSearch::scan(const PathIndex& index, const std::vector<QByteArray>& words, quint64 queryMask,
+                       std::vector<Match>& matches)
+{
+  // each slice fills its own list, so the result stays in name order
+  const quint32 count = index.fileCount();
+  const quint32 sliceCount = (count + SCAN_SLICE - 1) / SCAN_SLICE;
+  std::vector<std::vector<Match>> slices(sliceCount);
+  
+  for (quint32 slice = 0; slice < sliceCount; ++slice) {
+    m_scanPool.start([&index, &words, &slices, queryMask, count, slice]() {
+      const quint32 begin = slice * SCAN_SLICE;
+      const quint32 end = qMin(count, begin + SCAN_SLICE);
+      
+      std::vector<quint64> candidates;
+      Prefilter::candidates(index.masks() + begin, end - begin, queryMask, candidates);
+      for (size_t word = 0; word < candidates.size(); ++word) {
+        for (quint64 bits = candidates[word]; bits != 0; bits &= bits - 1) {
+          const quint32 file = begin + static_cast<quint32>(word * 64 + __builtin_ctzll(bits));
+          const int score = scoreName(index.text(index.files()[file].folded), words);
+          if (score > 0) { slices[slice].push_back({score, file}); }
+        }
+      }
+    });
+  }
+  m_scanPool.waitForDone();
+  
+  for (const std::vector<Match>& slice : slices) { matches.insert(matches.end(), slice.begin(), slice.end()); }
+}
+
+void FilesSearch::prefixMatches(const PathIndex& index, const QByteArray& prefix, std::vector<Match>& matches)
+{
+  const PathIndex::File* begin = index.files();
+  const PathIndex::File* end = begin + index.fileCount();
+  const PathIndex::File* it = std::lower_bound(begin, end, prefix, [&index](const PathIndex::File& file, const QByteArray& value) {
+    return std::strcmp(index.text(file.folded), value.constData()) < 0;
+  });
+  
+  const std::vector<QByteArray> words{prefix};
+  for (; it != end && matches.size() < static_cast<size_t>(MAX_RESULTS); ++it) {
+    const char* folded = index.text(it->folded);
+    if (std::strncmp(folded, prefix.constData(), static_cast<size_t>(prefix.size())) != 0) break;
+    matches.push_back({scoreName(folded, words), static_cast<quint32>(it - begin)});
+  }
+}
+
+int FilesSearch::scoreName(const char* folded, const std::vector<QByteArray>& words)
+{
+  const std::string_view name(folded);
+  
+  // a name is only as good as its weakest word
+  int score = 100;
+  for (const QByteArray& word : words) {
+    const std::string_view needle(word.constData(), static_cast<size_t>(word.size()));
+    int best = 0;
+    for (size_t pos = name.find(needle); pos != std::string_view::npos && best < 90; pos = name.find(needle, pos + 1)) {
+      if (pos == 0) {
+        // the whole name, the name without its extension, or its start
+        const size_t end = needle.size();
+        best = end == name.size() ? 100 : name[end] == '.' ? 95 : 90;
+      } else {
+        best = qMax(best, isWordChar(name[pos - 1]) ? 60 : 80);
+      }
+    }
+    if (best == 0) return 0;
+    score = qMin(score, best);
+  }
+  
+  // the longer the name around the match, the less likely it's the one meant
+  return score - qMin(10, static_cast<int>(name.size()) / 8);
+}
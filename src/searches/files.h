@@ -0,0 +1,81 @@
+#pragma once
+#include "searches.h"
+#include "pathindex.h"
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// files and folders under the configured roots, by name
+//
+// the roots are crawled into a PathIndex; a start maps the last one and
+// searches it right away, crawling again in the background once it's older
+// than REFRESH_AFTER_SECS or the roots or excludes changed. the rows for a
+// query are made into a small catalog of their own, which the results keep
+// alive
+class FilesSearch : public Search
+{
+  Q_OBJECT
+public:
+  // roots and excludes are read from $XDG_CONFIG_HOME/spotlight/files.conf:
+  // a path per line is a root, "!" in front excludes a path or a directory
+  // name; without roots the home directory is crawled
+  explicit FilesSearch(QObject* parent = nullptr);
+  ~FilesSearch() override;
+  
+  ResultList performSearch(const QString& query) override;
+  void load() override;
+
+private:
+  static constexpr qint64 REFRESH_AFTER_SECS = 3600;
+  static constexpr int MIN_SCAN_LENGTH = 3; // a shorter single word only matches name prefixes
+  static constexpr quint32 SCAN_SLICE = 1 << 18; // files per scan task
+  static constexpr int FILE_PENALTY = 10; // an app or setting wins over a file matching as well
+  
+  struct Match
+  {
+    int score;
+    quint32 file;
+  };
+  
+  void readConfig();
+  
+  // crawl on m_crawlPool unless a crawl is running or one started recently
+  void startCrawl();
+  void crawl();
+  
+  std::shared_ptr<const PathIndex> index() const;
+  void publishIndex(std::shared_ptr<const PathIndex> index);
+  
+  // every file whose mask passes, scored slice by slice on m_scanPool
+  void scan(const PathIndex& index, const std::vector<QByteArray>& words, quint64 queryMask,
+            std::vector<Match>& matches);
+  
+  // files whose folded name starts with prefix, in name order
+  static void prefixMatches(const PathIndex& index, const QByteArray& prefix, std::vector<Match>& matches);
+  
+  // 0 unless every word is in the folded name; a word starting the name or
+  // one of its words scores higher, a long name lower
+  static int scoreName(const char* folded, const std::vector<QByteArray>& words);
+  
+  QStringList m_roots;
+  QStringList m_excludes;
+  
+  mutable QMutex m_indexMutex; // guards m_index only, a mapped index never changes
+  std::shared_ptr<const PathIndex> m_index;
+  
+  QThreadPool m_crawlPool;
+  QThreadPool m_scanPool;
+  std::atomic<bool> m_crawling{false};
+  std::atomic<bool> m_cancelled{false}; // set on destruction, stops a crawl early
+  qint64 m_crawlStarted = 0; // only touched by whoever set m_crawling
+  
+  // narrowing state, only touched by performSearch
+  std::shared_ptr<const PathIndex> m_lastIndex;
+  QString m_lastQuery; // empty when there is nothing to narrow from
+  std::vector<quint32> m_lastMatches;
+};
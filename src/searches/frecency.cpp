@@ -0,0 +1,291 @@
+#include "frecency.h"
+#include "binaryio.h"
+#include <QByteArray>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace {
+
+constexpr quint32 MAGIC = 0x52465053; // "SPFR"
+constexpr quint32 VERSION = 3;
+constexpr quint32 LOG_MAGIC = 0x324c5053; // "SPL2"
+constexpr qint64 HEADER_SIZE = 24;
+
+// table layout (see binaryio.h for str):
+//   header  u32 magic, u32 version, u32 id count, u32 key count, u64 generation
+//   keys    key count x Key, sorted by prefix hash then id index, read in place
+//   ids     id count x str
+//
+// log layout, one record per launch:
+//   record  u32 log magic, u64 generation of the table then, i64 time,
+//           str folded query, str id
+
+} // namespace
+
+FrecencyStore::FrecencyStore(const QString& name)
+{
+  const QString base = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/spotlight/" + name;
+  m_tablePath = base + ".table";
+  m_logPath = base + ".log";
+}
+
+FrecencyStore::~FrecencyStore()
+{ unmap(); }
+
+void FrecencyStore::load()
+{
+  unmap();
+  m_ids.clear();
+  m_idIndex.clear();
+  m_recent.clear();
+  m_logRecords = 0;
+  
+  m_table.setFileName(m_tablePath);
+  if (m_table.open(QIODevice::ReadOnly)) {
+    m_size = m_table.size();
+    m_data = m_size > 0 ? m_table.map(0, m_size) : nullptr;
+    if (!m_data || !index()) {
+      unmap();
+      m_ids.clear();
+      m_idIndex.clear();
+    }
+  }
+  
+  // replay what was launched since; a record cut short by a crash ends it
+  bool damaged = false;
+  QFile log(m_logPath);
+  if (log.open(QIODevice::ReadOnly)) {
+    const QByteArray bytes = log.readAll();
+    BinaryReader reader{reinterpret_cast<const uchar*>(bytes.constData()), bytes.size()};
+    while (reader.pos < reader.size) {
+      bool valid = reader.read<quint32>() == LOG_MAGIC;
+      quint64 generation = reader.read<quint64>();
+      qint64 time = reader.read<qint64>();
+      QString query = reader.readString();
+      QString id = reader.readString();
+      if (!valid || !reader.ok) {
+        damaged = true;
+        break;
+      }
+      
+      // a crash between writing the table and removing the log leaves records
+      // the table already holds, they were written against an older one
+      if (generation >= m_generation) { apply(time, query, id); }
+      ++m_logRecords;
+    }
+  }
+  
+  // nothing could be appended after a bad record, so that's compacted away too
+  if (m_logRecords >= COMPACT_AFTER || damaged) { compact(); }
+}
+
+bool FrecencyStore::index()
+{
+  static_assert(sizeof(Key) == 32 && std::is_trivially_copyable<Key>::value, "Key is read in place");
+  
+  BinaryReader reader{m_data, m_size};
+  if (reader.read<quint32>() != MAGIC || reader.read<quint32>() != VERSION) return false;
+  
+  quint32 idCount = reader.read<quint32>();
+  quint32 keyCount = reader.read<quint32>();
+  m_generation = reader.read<quint64>();
+  if (!reader.ok || HEADER_SIZE + static_cast<qint64>(keyCount) * static_cast<qint64>(sizeof(Key)) > m_size) return false;
+  
+  // the header keeps the keys 8-byte aligned
+  m_keys = reinterpret_cast<const Key*>(m_data + HEADER_SIZE);
+  m_keyCount = keyCount;
+  
+  // ids are few, they're decoded up front so record() can add to them
+  reader.pos = HEADER_SIZE + static_cast<qint64>(keyCount) * static_cast<qint64>(sizeof(Key));
+  m_ids.reserve(idCount);
+  for (quint32 i = 0; i < idCount && reader.ok; ++i) {
+    QString id = reader.readString();
+    m_idIndex.insert(id, static_cast<quint32>(m_ids.size()));
+    m_ids.push_back(std::move(id));
+  }
+  
+  return reader.ok;
+}
+
+void FrecencyStore::unmap()
+{
+  if (m_data) { m_table.unmap(const_cast<uchar*>(m_data)); }
+  m_table.close();
+  m_data = nullptr;
+  m_size = 0;
+  m_keys = nullptr;
+  m_keyCount = 0;
+  m_generation = 0;
+}
+
+void FrecencyStore::record(const QString& foldedQuery, const QString& id)
+{
+  if (foldedQuery.isEmpty() || id.isEmpty()) return;
+  
+  const qint64 now = QDateTime::currentSecsSinceEpoch();
+  apply(now, foldedQuery, id);
+  
+  QByteArray out;
+  writeValue<quint32>(out, LOG_MAGIC);
+  writeValue<quint64>(out, m_generation);
+  writeValue<qint64>(out, now);
+  writeString(out, foldedQuery);
+  writeString(out, id);
+  
+  // one write per record, so a crash can only cut off the last one
+  QDir().mkpath(QFileInfo(m_logPath).absolutePath());
+  QFile log(m_logPath);
+  if (log.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    log.write(out);
+    ++m_logRecords;
+  }
+  
+  // a resident process may never load again, so it compacts as it goes
+  if (m_logRecords >= COMPACT_AFTER) { compact(); }
+}
+
+QHash<QString, double> FrecencyStore::scores(const QString& foldedQuery) const
+{
+  QHash<QString, double> result;
+  if (foldedQuery.isEmpty()) return result;
+  
+  const quint64 prefix = stableHash(QStringView(foldedQuery).left(MAX_PREFIX));
+  const qint64 now = QDateTime::currentSecsSinceEpoch();
+  
+  auto [begin, end] = mappedKeys(prefix);
+  for (const Key* key = begin; key != end; ++key) {
+    if (key->app < m_ids.size()) { result.insert(m_ids[key->app], decayed(*key, now)); }
+  }
+  
+  // launches since the table was written replace its counts
+  for (auto it = m_recent.lower_bound({prefix, 0}); it != m_recent.end() && it->first.first == prefix; ++it) {
+    result.insert(m_ids[it->first.second], decayed(it->second, now));
+  }
+  return result;
+}
+
+QString FrecencyStore::topHit(const QString& foldedQuery) const
+{
+  const QHash<QString, double> prefixScores = scores(foldedQuery);
+  
+  QString best;
+  double bestScore = TOP_HIT_MIN_SCORE;
+  for (auto it = prefixScores.constBegin(); it != prefixScores.constEnd(); ++it) {
+    if (it.value() >= bestScore) {
+      best = it.key();
+      bestScore = it.value();
+    }
+  }
+  return best;
+}
+
+std::pair<const FrecencyStore::Key*, const FrecencyStore::Key*> FrecencyStore::mappedKeys(quint64 prefix) const
+{
+  const Key* begin = m_keys;
+  const Key* end = m_keys + m_keyCount;
+  auto lower = std::lower_bound(begin, end, prefix, [](const Key& key, quint64 value) { return key.prefix < value; });
+  auto upper = std::upper_bound(lower, end, prefix, [](quint64 value, const Key& key) { return value < key.prefix; });
+  return {lower, upper};
+}
+
+void FrecencyStore::apply(qint64 time, const QString& foldedQuery, const QString& id)
+{
+  const quint32 index = idIndex(id);
+  
+  const int length = qMin(static_cast<int>(foldedQuery.size()), MAX_PREFIX);
+  for (int i = 1; i <= length; ++i) {
+    const quint64 prefix = stableHash(QStringView(foldedQuery).left(i));
+    
+    auto recent = m_recent.find({prefix, index});
+    if (recent == m_recent.end()) {
+      // start from what the table had, if anything
+      Key key{prefix, index, 0, 0.0, time};
+      auto [begin, end] = mappedKeys(prefix);
+      auto mapped = std::find_if(begin, end, [&](const Key& candidate) { return candidate.app == index; });
+      if (mapped != end) { key = *mapped; }
+      recent = m_recent.emplace(std::make_pair(prefix, index), key).first;
+    }
+    
+    Key& key = recent->second;
+    key.score = decayed(key, time) + 1.0;
+    key.lastUsed = qMax(key.lastUsed, time);
+  }
+}
+
+quint32 FrecencyStore::idIndex(const QString& id)
+{
+  auto it = m_idIndex.constFind(id);
+  if (it != m_idIndex.constEnd()) return *it;
+  
+  const quint32 index = static_cast<quint32>(m_ids.size());
+  m_ids.push_back(id);
+  m_idIndex.insert(id, index);
+  return index;
+}
+
+bool FrecencyStore::compact()
+{
+  const qint64 now = QDateTime::currentSecsSinceEpoch();
+  
+  // table keys with the recent ones laid over them, both sorted the same way
+  std::vector<Key> keys;
+  keys.reserve(m_keyCount + m_recent.size());
+  auto recent = m_recent.begin();
+  for (quint32 i = 0; i <= m_keyCount; ++i) {
+    const Key* mapped = i < m_keyCount ? &m_keys[i] : nullptr;
+    for (; recent != m_recent.end(); ++recent) {
+      if (mapped && recent->first > std::make_pair(mapped->prefix, mapped->app)) break;
+      keys.push_back(recent->second);
+    }
+    if (mapped && (keys.empty() || keys.back().prefix != mapped->prefix || keys.back().app != mapped->app)) {
+      keys.push_back(*mapped);
+    }
+  }
+  
+  // forget what hasn't been launched in months, and the ids only it used
+  keys.erase(std::remove_if(keys.begin(), keys.end(), [&](const Key& key) { return decayed(key, now) < FORGET_BELOW; }),
+             keys.end());
+  std::vector<quint32> remap(m_ids.size(), 0);
+  for (const Key& key : keys) { remap[key.app] = 1; }
+  
+  // numbered in their old order, so the keys stay sorted by (prefix, app)
+  std::vector<const QString*> ids;
+  for (size_t i = 0; i < remap.size(); ++i) {
+    if (remap[i] == 0) continue;
+    ids.push_back(&m_ids[i]);
+    remap[i] = static_cast<quint32>(ids.size());
+  }
+  for (Key& key : keys) { key.app = remap[key.app] - 1; }
+  
+  QByteArray out;
+  writeValue<quint32>(out, MAGIC);
+  writeValue<quint32>(out, VERSION);
+  writeValue<quint32>(out, static_cast<quint32>(ids.size()));
+  writeValue<quint32>(out, static_cast<quint32>(keys.size()));
+  writeValue<quint64>(out, m_generation + 1);
+  for (const Key& key : keys) { writeValue<Key>(out, key); }
+  for (const QString* id : ids) { writeString(out, *id); }
+  
+  QDir().mkpath(QFileInfo(m_tablePath).absolutePath());
+  
+  QSaveFile file(m_tablePath);
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  file.write(out);
+  if (!file.commit()) return false;
+  
+  QFile::remove(m_logPath);
+  load();
+  return true;
+}
+
+double FrecencyStore::decayed(const Key& key, qint64 now)
+{
+  const double age = static_cast<double>(qMax<qint64>(0, now - key.lastUsed));
+  return key.score * std::exp2(-age / HALF_LIFE_SECS);
+}
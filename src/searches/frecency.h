@@ -0,0 +1,83 @@
+#pragma once
+#include <QString>
+#include <QHash>
+#include <QFile>
+#include <map>
+#include <utility>
+#include <vector>
+
+// launch history: how often and how recently each result id was picked for
+// a query prefix, so the usual picks rank first and can show before any
+// provider has finished
+//
+// launches are appended to $XDG_DATA_HOME/spotlight/<name>.log and replayed
+// over the mapped <name>.table at load; once the log has grown past
+// COMPACT_AFTER records (checked at load and on record) both are folded
+// into a new table
+class FrecencyStore
+{
+public:
+  // launches are remembered under each prefix of the query up to this length
+  static constexpr int MAX_PREFIX = 6;
+  
+  // a launch counts half as much after this long
+  static constexpr qint64 HALF_LIFE_SECS = 7 * 24 * 3600;
+  
+  explicit FrecencyStore(const QString& name);
+  ~FrecencyStore();
+  
+  // map the table and replay the log, compacting if it's due
+  void load();
+  
+  // remember that the result with this id was picked for foldedQuery
+  void record(const QString& foldedQuery, const QString& id);
+  
+  // result id -> decayed launch count for foldedQuery's prefix
+  QHash<QString, double> scores(const QString& foldedQuery) const;
+  
+  // id of the usual pick for foldedQuery's prefix, empty until one was
+  // picked often enough
+  QString topHit(const QString& foldedQuery) const;
+
+private:
+  static constexpr int COMPACT_AFTER = 64;
+  static constexpr double TOP_HIT_MIN_SCORE = 2.0;
+  static constexpr double FORGET_BELOW = 0.05; // dropped at compaction
+  
+  // one (prefix, app) pair, also the table's record layout
+  struct Key
+  {
+    quint64 prefix; // stableHash of the prefix
+    quint32 app; // index into m_ids
+    quint32 reserved;
+    double score; // decayed launch count as of lastUsed
+    qint64 lastUsed; // seconds since the epoch
+  };
+  
+  void unmap();
+  bool index();
+  
+  // mapped keys for prefix, sorted by app
+  std::pair<const Key*, const Key*> mappedKeys(quint64 prefix) const;
+  
+  // count one launch of app at time under every prefix of foldedQuery
+  void apply(qint64 time, const QString& foldedQuery, const QString& id);
+  quint32 idIndex(const QString& id);
+  bool compact();
+  
+  static double decayed(const Key& key, qint64 now);
+  
+  QString m_tablePath;
+  QString m_logPath;
+  QFile m_table;
+  const uchar* m_data = nullptr;
+  qint64 m_size = 0;
+  const Key* m_keys = nullptr; // points into the map
+  quint32 m_keyCount = 0;
+  quint64 m_generation = 0; // bumped by every compaction, logged with each launch
+  
+  std::vector<QString> m_ids; // the table's ids, then ones launched since
+  QHash<QString, quint32> m_idIndex; // id -> index into m_ids
+  std::map<std::pair<quint64, quint32>, Key> m_recent; // logged since compaction, wins over the table
+  int m_logRecords = 0;
+};
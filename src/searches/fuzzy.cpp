@@ -0,0 +1,108 @@
+#include "fuzzy.h"
+#include <algorithm>
+
+quint64 FuzzyMatcher::charMask(QStringView folded)
+{
+  quint64 mask = 0;
+  for (QChar c : folded) {
+    char16_t u = c.unicode();
+    if (u >= 'a' && u <= 'z') { mask |= quint64(1) << (u - 'a'); }
+    else if (u >= '0' && u <= '9') { mask |= quint64(1) << (26 + u - '0'); }
+    else if (u != ' ') { mask |= quint64(1) << (36 + u % 28); }
+  }
+  return mask;
+}
+
+int FuzzyMatcher::bonusAt(QStringView text, QByteArrayView boundaries, qsizetype pos)
+{
+  if (pos == 0) return BONUS_START;
+  
+  if (!boundaries.isEmpty()) {
+    switch (boundaries[pos]) {
+      case WORD_BOUNDARY: return BONUS_WORD;
+      case CAMEL_BOUNDARY: return BONUS_CAMEL;
+      default: return 0;
+    }
+  }
+  
+  return text[pos - 1].isLetterOrNumber() ? 0 : BONUS_WORD;
+}
+
+int FuzzyMatcher::scoreWindow(QStringView query, QStringView text, QByteArrayView boundaries, qsizetype start, qsizetype end)
+{
+  int score = 0;
+  int runBonus = 0; // bonus of the char that started the current run
+  bool inRun = false;
+  bool inGap = false;
+  qsizetype queryIdx = 0;
+  
+  for (qsizetype i = start; i <= end; ++i) {
+    if (queryIdx < query.size() && text[i] == query[queryIdx]) {
+      int bonus = bonusAt(text, boundaries, i);
+      if (!inRun) {
+        runBonus = bonus;
+      } else {
+        // a run carries its start's bonus, a new word inside it takes over
+        if (bonus >= BONUS_WORD && bonus > runBonus) { runBonus = bonus; }
+        bonus = std::max({bonus, runBonus, BONUS_CONSECUTIVE});
+      }
+      
+      score += SCORE_MATCH + (queryIdx == 0 ? bonus * BONUS_FIRST_CHAR_MULTIPLIER : bonus);
+      inRun = true;
+      inGap = false;
+      ++queryIdx;
+    } else {
+      score += inGap ? SCORE_GAP_EXTENSION : SCORE_GAP_START;
+      inRun = false;
+      inGap = true;
+    }
+  }
+  
+  return score;
+}
+
+int FuzzyMatcher::score(QStringView query, QStringView text, QByteArrayView boundaries)
+{
+  const qsizetype queryLen = query.size();
+  const qsizetype textLen = text.size();
+  if (queryLen == 0 || queryLen > textLen) return 0;
+  
+  if (text == query) return 100;
+  
+  // forward: the earliest point the whole query has been seen in order
+  qsizetype queryIdx = 0;
+  qsizetype end = -1;
+  for (qsizetype i = 0; i < textLen; ++i) {
+    if (text[i] == query[queryIdx] && ++queryIdx == queryLen) {
+      end = i;
+      break;
+    }
+  }
+  if (end < 0) return 0;
+  
+  // backward from there: the latest start, i.e. the tightest window
+  qsizetype start = end;
+  queryIdx = queryLen - 1;
+  for (qsizetype i = end; i >= 0; --i) {
+    if (text[i] == query[queryIdx]) {
+      if (queryIdx == 0) {
+        start = i;
+        break;
+      }
+      --queryIdx;
+    }
+  }
+  
+  int best = scoreWindow(query, text, boundaries, start, end);
+  
+  // the greedy window can miss a contiguous hit at a word start later on
+  for (qsizetype pos = text.indexOf(query); pos != -1; pos = text.indexOf(query, pos + 1)) {
+    best = std::max(best, scoreWindow(query, text, boundaries, pos, pos + queryLen - 1));
+  }
+  
+  // a contiguous run from the very start is as good as it gets short of exact
+  const int perfect = int(queryLen) * (SCORE_MATCH + BONUS_START) + BONUS_START;
+  
+  // keep every match above zero, narrowing relies on that
+  return std::clamp(30 + 60 * best / perfect, 1, 90);
+}
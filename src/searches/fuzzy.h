@@ -0,0 +1,43 @@
+#pragma once
+#include <QByteArrayView>
+#include <QStringView>
+#include <QtGlobal>
+
+// fzf-style matcher over folded text: a character bitmask rejects most
+// entries outright, the rest get a subsequence score that rewards word
+// starts, camelCase humps and contiguous runs
+class FuzzyMatcher
+{
+public:
+  // what starts at a position of folded text, see Catalog::fold
+  enum Boundary : char
+  {
+    NO_BOUNDARY = 0,
+    CAMEL_BOUNDARY = 1, // fooBar, foo2
+    WORD_BOUNDARY = 2, // after a space or punctuation
+  };
+  
+  // one bit per letter/digit (everything else shares the top bits)
+  static quint64 charMask(QStringView folded);
+  
+  // the text can only contain query as a subsequence if this holds
+  static bool mayContain(quint64 textMask, quint64 queryMask) { return (queryMask & ~textMask) == 0; }
+  
+  // 0 for no match, 100 for an exact match, 90 for a prefix and less the
+  // more scattered the match is; boundaries comes from Catalog::fold, when
+  // empty word starts are guessed from the text itself
+  static int score(QStringView query, QStringView text, QByteArrayView boundaries = QByteArrayView());
+
+private:
+  static constexpr int SCORE_MATCH = 16;
+  static constexpr int SCORE_GAP_START = -3;
+  static constexpr int SCORE_GAP_EXTENSION = -1;
+  static constexpr int BONUS_START = 10; // match begins the text
+  static constexpr int BONUS_WORD = 8;
+  static constexpr int BONUS_CAMEL = 7;
+  static constexpr int BONUS_CONSECUTIVE = 4;
+  static constexpr int BONUS_FIRST_CHAR_MULTIPLIER = 2;
+  
+  static int bonusAt(QStringView text, QByteArrayView boundaries, qsizetype pos);
+  static int scoreWindow(QStringView query, QStringView text, QByteArrayView boundaries, qsizetype start, qsizetype end);
+};
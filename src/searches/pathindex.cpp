@@ -0,0 +1,242 @@
+#include "pathindex.h"
+#include "binaryio.h"
+#include "catalog.h"
+#include "fuzzy.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+constexpr quint32 MAGIC = 0x58465053; // "SPFX"
+constexpr quint32 VERSION = 2;
+constexpr qint64 HEADER_SIZE = 40;
+
+// layout, all read in place:
+//   header  u32 magic, u32 version, u32 dir count, u32 file count,
+//           i64 name bytes, i64 crawled at, u64 excludes hash
+//   dirs    dir count x Dir, roots first, every parent before its children
+//   files   file count x File, sorted by folded name
+//   masks   file count x u64, FuzzyMatcher::charMask of the folded name
+//   names   name bytes of NUL-terminated utf-8, each distinct name once
+
+template <typename T>
+bool writeArray(QSaveFile& file, const std::vector<T>& values)
+{
+  const qint64 bytes = static_cast<qint64>(values.size() * sizeof(T));
+  return file.write(reinterpret_cast<const char*>(values.data()), bytes) == bytes;
+}
+
+// the same for the same excludes in any order
+quint64 hashExcludes(QStringList excludes)
+{
+  excludes.sort();
+  quint64 hash = STABLE_HASH_BASIS;
+  for (const QString& exclude : excludes) { hash = stableHash(u"\n", stableHash(exclude, hash)); }
+  return hash;
+}
+
+} // namespace
+
+PathIndex::PathIndex(const QString& name)
+{
+  m_path = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) +
+           "/spotlight/" + name + ".index";
+}
+
+PathIndex::~PathIndex()
+{ unmap(); }
+
+bool PathIndex::load()
+{
+  unmap();
+  
+  m_file.setFileName(m_path);
+  if (!m_file.open(QIODevice::ReadOnly)) return false;
+  
+  m_size = m_file.size();
+  m_data = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+  if (!m_data || !index()) {
+    unmap();
+    return false;
+  }
+  return true;
+}
+
+bool PathIndex::index()
+{
+  static_assert(sizeof(Dir) == 8 && std::is_trivially_copyable<Dir>::value, "Dir is read in place");
+  static_assert(sizeof(File) == 16 && std::is_trivially_copyable<File>::value, "File is read in place");
+  
+  BinaryReader reader{m_data, m_size};
+  if (reader.read<quint32>() != MAGIC || reader.read<quint32>() != VERSION) return false;
+  
+  const quint32 dirCount = reader.read<quint32>();
+  const quint32 fileCount = reader.read<quint32>();
+  const qint64 nameBytes = reader.read<qint64>();
+  const qint64 crawledAt = reader.read<qint64>();
+  const quint64 excludesHash = reader.read<quint64>();
+  
+  const qint64 filesAt = HEADER_SIZE + static_cast<qint64>(dirCount) * static_cast<qint64>(sizeof(Dir));
+  const qint64 masksAt = filesAt + static_cast<qint64>(fileCount) * static_cast<qint64>(sizeof(File));
+  const qint64 namesAt = masksAt + static_cast<qint64>(fileCount) * static_cast<qint64>(sizeof(quint64));
+  if (!reader.ok || nameBytes < 0 || namesAt + nameBytes > m_size) return false;
+  
+  // the names end in a NUL, so text() never reads past the map
+  if (nameBytes > 0 && m_data[namesAt + nameBytes - 1] != 0) return false;
+  
+  // the header and records keep the masks 8-byte aligned
+  m_dirs = reinterpret_cast<const Dir*>(m_data + HEADER_SIZE);
+  m_files = reinterpret_cast<const File*>(m_data + filesAt);
+  m_masks = reinterpret_cast<const quint64*>(m_data + masksAt);
+  m_names = reinterpret_cast<const char*>(m_data + namesAt);
+  m_dirCount = dirCount;
+  m_fileCount = fileCount;
+  m_nameBytes = nameBytes;
+  m_crawledAt = crawledAt;
+  m_excludesHash = excludesHash;
+  return true;
+}
+
+void PathIndex::unmap()
+{
+  if (m_data) { m_file.unmap(const_cast<uchar*>(m_data)); }
+  m_file.close();
+  m_data = nullptr;
+  m_size = 0;
+  m_dirs = nullptr;
+  m_files = nullptr;
+  m_masks = nullptr;
+  m_names = nullptr;
+  m_dirCount = 0;
+  m_fileCount = 0;
+  m_nameBytes = 0;
+  m_crawledAt = 0;
+  m_excludesHash = 0;
+}
+
+bool PathIndex::save(const FileCrawler::Result& crawl, const QStringList& excludes) const
+{
+  // index.html, README.md, src: names repeat a lot across a tree, and most
+  // names are their own folded form
+  QByteArray names;
+  QHash<QByteArray, quint32> offsets;
+  auto intern = [&](const QByteArray& text) {
+    auto it = offsets.constFind(text);
+    if (it != offsets.constEnd()) return *it;
+    
+    const quint32 offset = static_cast<quint32>(names.size());
+    names.append(text.constData(), text.size() + 1);
+    offsets.insert(text, offset);
+    return offset;
+  };
+  
+  std::vector<Dir> dirs;
+  dirs.reserve(crawl.dirs.size());
+  for (const FileCrawler::Entry& dir : crawl.dirs) {
+    dirs.push_back({dir.parent, intern(QByteArray(crawl.names.constData() + dir.name))});
+  }
+  
+  struct Row
+  {
+    File file;
+    quint64 mask;
+  };
+  std::vector<Row> rows;
+  rows.reserve(crawl.files.size());
+  for (const FileCrawler::Entry& entry : crawl.files) {
+    const QByteArray name(crawl.names.constData() + entry.name);
+    const QString folded = Catalog::fold(QFile::decodeName(name));
+    const quint32 flags = entry.directory ? DIRECTORY : 0;
+    rows.push_back({{entry.parent, intern(name), intern(folded.toUtf8()), flags}, FuzzyMatcher::charMask(folded)});
+  }
+  offsets.clear();
+  
+  // by folded name, the name on disk breaks ties so the order is stable
+  const char* text = names.constData();
+  std::sort(rows.begin(), rows.end(), [text](const Row& a, const Row& b) {
+    const int order = std::strcmp(text + a.file.folded, text + b.file.folded);
+    return order != 0 ? order < 0 : std::strcmp(text + a.file.name, text + b.file.name) < 0;
+  });
+  
+  std::vector<File> files;
+  std::vector<quint64> masks;
+  files.reserve(rows.size());
+  masks.reserve(rows.size());
+  for (const Row& row : rows) {
+    files.push_back(row.file);
+    masks.push_back(row.mask);
+  }
+  rows.clear();
+  rows.shrink_to_fit();
+  
+  QByteArray header;
+  writeValue<quint32>(header, MAGIC);
+  writeValue<quint32>(header, VERSION);
+  writeValue<quint32>(header, static_cast<quint32>(dirs.size()));
+  writeValue<quint32>(header, static_cast<quint32>(files.size()));
+  writeValue<qint64>(header, names.size());
+  writeValue<qint64>(header, QDateTime::currentSecsSinceEpoch());
+  writeValue<quint64>(header, hashExcludes(excludes));
+  
+  QDir().mkpath(QFileInfo(m_path).absolutePath());
+  
+  QSaveFile file(m_path);
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  if (file.write(header) != header.size() || !writeArray(file, dirs) || !writeArray(file, files) ||
+      !writeArray(file, masks) || file.write(names) != names.size()) {
+    file.cancelWriting();
+    return false;
+  }
+  return file.commit();
+}
+
+QByteArray PathIndex::encodedDirPath(quint32 dir) const
+{
+  // up to the root, a parent always comes before its children
+  std::vector<const char*> parts;
+  while (dir < m_dirCount) {
+    parts.push_back(text(m_dirs[dir].name));
+    if (m_dirs[dir].parent >= dir) break;
+    dir = m_dirs[dir].parent;
+  }
+  
+  QByteArray path;
+  for (auto it = parts.rbegin(); it != parts.rend(); ++it) {
+    if (!path.isEmpty() && !path.endsWith('/')) { path += '/'; }
+    path += *it;
+  }
+  return path;
+}
+
+QString PathIndex::dirPath(quint32 dir) const
+{ return QFile::decodeName(encodedDirPath(dir)); }
+
+QString PathIndex::filePath(quint32 file) const
+{
+  if (file >= m_fileCount) return QString();
+  
+  QByteArray path = encodedDirPath(m_files[file].dir);
+  if (!path.endsWith('/')) { path += '/'; }
+  path += text(m_files[file].name);
+  return QFile::decodeName(path);
+}
+
+bool PathIndex::hasExcludes(const QStringList& excludes) const
+{ return m_data && m_excludesHash == hashExcludes(excludes); }
+
+QStringList PathIndex::roots() const
+{
+  QStringList roots;
+  for (quint32 i = 0; i < m_dirCount && m_dirs[i].parent == NO_PARENT; ++i) {
+    roots.append(QFile::decodeName(text(m_dirs[i].name)));
+  }
+  return roots;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "filecrawler.h"
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+// crawled paths persisted under $XDG_CACHE_HOME/spotlight/<name>.index and
+// searched straight from the map, so a start never has to crawl first
+//
+// paths are stored as a tree, each directory once as its name and its
+// parent's index. the file table is sorted by folded name, so a name prefix
+// is a range, with a character mask per file alongside for Prefilter. every
+// distinct name is stored once, however many directories it turns up in
+class PathIndex
+{
+public:
+  static constexpr quint32 NO_PARENT = FileCrawler::NO_PARENT;
+  static constexpr quint32 DIRECTORY = 1; // File::flags
+  
+  struct Dir
+  {
+    quint32 parent; // index into the dirs, NO_PARENT for a root
+    quint32 name; // text() offset, roots are full paths
+  };
+  
+  struct File
+  {
+    quint32 dir; // the directory it's in
+    quint32 name; // text() offset of the name as on disk
+    quint32 folded; // text() offset of Catalog::fold of the name
+    quint32 flags;
+  };
+  
+  explicit PathIndex(const QString& name);
+  ~PathIndex();
+  
+  // map the index file, returns false (and acts empty) if missing or invalid
+  bool load();
+  
+  // fold, sort and write a crawl made with these excludes to the index file;
+  // it's replaced in one rename, so any PathIndex still mapping the old one
+  // keeps working
+  bool save(const FileCrawler::Result& crawl, const QStringList& excludes) const;
+  
+  quint32 fileCount() const { return m_fileCount; }
+  const File* files() const { return m_files; }
+  const quint64* masks() const { return m_masks; }
+  
+  // NUL-terminated utf-8 at a name offset
+  const char* text(quint32 offset) const { return offset < m_nameBytes ? m_names + offset : ""; }
+  
+  QString dirPath(quint32 dir) const;
+  QString filePath(quint32 file) const;
+  
+  QStringList roots() const;
+  
+  // whether the crawl skipped these excludes, in any order
+  bool hasExcludes(const QStringList& excludes) const;
+  qint64 crawledAt() const { return m_crawledAt; } // seconds since the epoch
+
+private:
+  void unmap();
+  bool index();
+  QByteArray encodedDirPath(quint32 dir) const;
+  
+  QString m_path;
+  QFile m_file;
+  const uchar* m_data = nullptr;
+  qint64 m_size = 0;
+  
+  // point into the map
+  const Dir* m_dirs = nullptr;
+  const File* m_files = nullptr;
+  const quint64* m_masks = nullptr;
+  const char* m_names = nullptr;
+  quint32 m_dirCount = 0;
+  quint32 m_fileCount = 0;
+  qint64 m_nameBytes = 0;
+  qint64 m_crawledAt = 0;
+  quint64 m_excludesHash = 0;
+};
@@ -0,0 +1,78 @@
+#include "prefilter.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PREFILTER_X86 1
+#endif
+
+namespace {
+
+using Kernel = void (*)(const quint64*, size_t, quint64, quint64*);
+
+void scalarKernel(const quint64* masks, size_t count, quint64 queryMask, quint64* bits)
+{
+  for (size_t i = 0; i < count; ++i) {
+    if ((masks[i] & queryMask) == queryMask) { bits[i / 64] |= quint64(1) << (i % 64); }
+  }
+}
+
+#ifdef PREFILTER_X86
+__attribute__((target("avx2")))
+void avx2Kernel(const quint64* masks, size_t count, quint64 queryMask, quint64* bits)
+{
+  const __m256i query = _mm256_set1_epi64x(static_cast<long long>(queryMask));
+  
+  // 64 masks per output word, 4 per compare
+  size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    quint64 word = 0;
+    for (size_t j = 0; j < 64; j += 4) {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i + j));
+      __m256i hit = _mm256_cmpeq_epi64(_mm256_and_si256(block, query), query);
+      word |= quint64(_mm256_movemask_pd(_mm256_castsi256_pd(hit))) << j;
+    }
+    bits[i / 64] = word;
+  }
+  scalarKernel(masks + i, count - i, queryMask, bits + i / 64);
+}
+
+__attribute__((target("sse4.1")))
+void sse41Kernel(const quint64* masks, size_t count, quint64 queryMask, quint64* bits)
+{
+  const __m128i query = _mm_set1_epi64x(static_cast<long long>(queryMask));
+  
+  // 64 masks per output word, 2 per compare
+  size_t i = 0;
+  for (; i + 64 <= count; i += 64) {
+    quint64 word = 0;
+    for (size_t j = 0; j < 64; j += 2) {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + i + j));
+      __m128i hit = _mm_cmpeq_epi64(_mm_and_si128(block, query), query);
+      word |= quint64(_mm_movemask_pd(_mm_castsi128_pd(hit))) << j;
+    }
+    bits[i / 64] = word;
+  }
+  scalarKernel(masks + i, count - i, queryMask, bits + i / 64);
+}
+#endif
+
+Kernel pickKernel()
+{
+#ifdef PREFILTER_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return avx2Kernel;
+  if (__builtin_cpu_supports("sse4.1")) return sse41Kernel;
+#endif
+  return scalarKernel;
+}
+
+} // namespace
+
+void Prefilter::candidates(const quint64* masks, size_t count, quint64 queryMask, std::vector<quint64>& candidates)
+{
+  candidates.assign((count + 63) / 64, 0);
+  
+  // picked once, the first time it's needed
+  static const Kernel kernel = pickKernel();
+  if (count > 0) { kernel(masks, count, queryMask, candidates.data()); }
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <QtGlobal>
+#include <vector>
+
+// bulk first pass over a catalog's contiguous character masks: marks the
+// entries whose mask holds every bit of the query's, the scorer only looks
+// at those. uses AVX2 or SSE4.1 when the cpu has them, picked at runtime
+class Prefilter
+{
+public:
+  // bit i of candidates (64 per word) is set when masks[i] may match
+  static void candidates(const quint64* masks, size_t count, quint64 queryMask, std::vector<quint64>& candidates);
+};
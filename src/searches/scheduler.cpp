@@ -0,0 +1,239 @@
+#include "scheduler.h"
+#include "catalog.h"
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+SearchScheduler::SearchScheduler(QObject* parent) : QObject(parent)
+{
+  m_budgetTimer.setSingleShot(true);
+  connect(&m_budgetTimer, &QTimer::timeout, this, &SearchScheduler::publishIfReady);
+}
+
+SearchScheduler::~SearchScheduler()
+{
+  // workers use the providers, which are deleted with us
+  cancel();
+  m_pool.waitForDone();
+  m_loadPool.waitForDone();
+}
+
+void SearchScheduler::addProvider(Search* provider, int budgetMs)
+{
+  provider->setParent(this);
+  
+  auto slot = std::make_unique<Provider>();
+  slot->search = provider;
+  slot->budgetMs = budgetMs;
+  m_providers.push_back(std::move(slot));
+  
+  // emitted from the load thread, so this arrives queued
+  connect(provider, &Search::catalogChanged, this, &SearchScheduler::onCatalogChanged);
+  
+  // a thread per provider so a slow one never queues the others behind it
+  int providerCount = static_cast<int>(m_providers.size());
+  if (m_pool.maxThreadCount() < providerCount) { m_pool.setMaxThreadCount(providerCount); }
+}
+
+void SearchScheduler::load()
+{
+  // small and needed for the first keystroke, so it's read right here
+  m_frecency.load();
+  
+  for (const auto& provider : m_providers) {
+    Search* search = provider->search;
+    m_loadPool.start([search]() { search->load(); });
+  }
+}
+
+quint64 SearchScheduler::submit(const QString& query)
+{
+  const quint64 generation = ++m_generation;
+  
+  m_query = query;
+  m_published = false;
+  m_elapsed.start();
+  for (const auto& provider : m_providers) {
+    provider->results.clear();
+    provider->finished = false;
+  }
+  
+  // nothing changed since this exact query was answered, skip the providers
+  const QString foldedQuery = Catalog::fold(query);
+  m_cacheKey = {m_catalogGeneration, foldedQuery};
+  if (const ResultList* cached = m_resultCache.object(m_cacheKey)) {
+    m_published = true;
+    m_budgetTimer.stop();
+    emit resultsReady(generation, m_query, *cached);
+    return generation;
+  }
+  
+  m_boosts = m_frecency.scores(foldedQuery);
+  
+  // the usual pick for this prefix shows right away, the providers' first
+  // paint replaces it (and keeps it selected, it's boosted to the top there);
+  // it's looked up in the current catalogs, so an uninstalled app never shows
+  const QString hitId = m_frecency.topHit(foldedQuery);
+  for (int i = 0; i < static_cast<int>(m_providers.size()) && !hitId.isEmpty(); ++i) {
+    ResultList hit = m_providers[i]->search->resultForId(hitId);
+    if (hit.empty()) continue;
+    
+    QMetaObject::invokeMethod(this, [this, generation, hit = std::move(hit)]() {
+      if (isCurrent(generation) && !m_published) { emit resultsReady(generation, m_query, hit); }
+    }, Qt::QueuedConnection);
+    break;
+  }
+  
+  for (int i = 0; i < static_cast<int>(m_providers.size()); ++i) {
+    m_pool.start([this, generation, i, query]() { runProvider(generation, i, query); });
+  }
+  
+  // arms the budget timer
+  publishIfReady();
+  
+  return generation;
+}
+
+void SearchScheduler::cancel()
+{
+  ++m_generation;
+  m_budgetTimer.stop();
+}
+
+void SearchScheduler::runProvider(quint64 generation, int index, const QString& query)
+{
+  Provider& provider = *m_providers[index];
+  ResultList results;
+  
+  {
+    QMutexLocker locker(&provider.mutex);
+    
+    // a newer query came in while we waited, nobody will look at this one
+    if (!isCurrent(generation)) return;
+    
+    results = provider.search->performSearch(query);
+  }
+  
+  // hand results to our own thread, which checks the generation again
+  QMetaObject::invokeMethod(this, [this, generation, index, results = std::move(results)]() mutable {
+    onProviderFinished(generation, index, std::move(results));
+  }, Qt::QueuedConnection);
+}
+
+void SearchScheduler::onProviderFinished(quint64 generation, int index, ResultList results)
+{
+  if (!isCurrent(generation)) return;
+  
+  Provider& provider = *m_providers[index];
+  provider.results = std::move(results);
+  provider.finished = true;
+  applyFrecency(provider.results.results);
+  
+  // after the first paint, late providers stream straight in
+  if (m_published) {
+    publish();
+  } else {
+    publishIfReady();
+  }
+}
+
+void SearchScheduler::onCatalogChanged()
+{
+  ++m_catalogGeneration;
+  m_resultCache.clear();
+  emit catalogChanged();
+}
+
+void SearchScheduler::recordLaunch(const QString& query, const QString& id)
+{
+  m_frecency.record(Catalog::fold(query), id);
+  
+  // the boosts in the cached lists are out of date now
+  m_resultCache.clear();
+}
+
+void SearchScheduler::applyFrecency(std::vector<SearchResult>& results) const
+{
+  if (m_boosts.isEmpty()) return;
+  
+  bool boosted = false;
+  for (SearchResult& result : results) {
+    const QString& id = result.entry().id;
+    auto it = m_boosts.constFind(id);
+    if (it == m_boosts.constEnd() || id.isEmpty()) continue;
+    
+    result.score += qMin(MAX_FRECENCY_BOOST, static_cast<int>(std::lround(FRECENCY_BOOST * std::log2(1.0 + *it))));
+    boosted = true;
+  }
+  
+  // stable, so equal scores keep the provider's order
+  if (boosted) { std::stable_sort(results.begin(), results.end()); }
+}
+
+void SearchScheduler::publishIfReady()
+{
+  if (m_published) return;
+  
+  // wait for the unfinished provider whose budget runs out soonest
+  qint64 elapsed = m_elapsed.elapsed();
+  qint64 wait = -1;
+  for (const auto& provider : m_providers) {
+    if (provider->finished) continue;
+    
+    qint64 remaining = provider->budgetMs - elapsed;
+    if (remaining > 0 && (wait < 0 || remaining < wait)) { wait = remaining; }
+  }
+  
+  if (wait > 0) {
+    m_budgetTimer.start(static_cast<int>(wait));
+    return;
+  }
+  
+  publish();
+}
+
+void SearchScheduler::publish()
+{
+  m_published = true;
+  m_budgetTimer.stop();
+  
+  // providers return sorted lists, so k-way merge their heads rather than
+  // sorting again; there are only a handful, a linear pick beats a heap
+  const int providerCount = static_cast<int>(m_providers.size());
+  std::vector<size_t> heads(providerCount, 0);
+  ResultList merged;
+  
+  while (static_cast<int>(merged.size()) < Search::MAX_RESULTS) {
+    int best = -1;
+    for (int i = 0; i < providerCount; ++i) {
+      const Provider& provider = *m_providers[i];
+      if (!provider.finished || heads[i] >= provider.results.size()) continue;
+      
+      // strictly greater, so equal scores keep provider order
+      if (best < 0 || provider.results.results[heads[i]].score >
+                      m_providers[best]->results.results[heads[best]].score) {
+        best = i;
+      }
+    }
+    if (best < 0) break;
+    
+    merged.results.push_back(m_providers[best]->results.results[heads[best]++]);
+  }
+  
+  // the merged handles point into the providers' snapshots
+  for (const auto& provider : m_providers) {
+    for (const auto& catalog : provider->results.catalogs) { merged.keep(catalog); }
+  }
+  
+  // only complete lists are worth replaying, a partial first paint isn't;
+  // one that straddled a catalog change is keyed by the old generation
+  bool complete = std::all_of(m_providers.begin(), m_providers.end(),
+                              [](const std::unique_ptr<Provider>& provider) { return provider->finished; });
+  if (complete) {
+    m_resultCache.insert(m_cacheKey, new ResultList(merged));
+  }
+  
+  emit resultsReady(m_generation.load(), m_query, merged);
+}
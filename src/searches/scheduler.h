@@ -0,0 +1,108 @@
+#pragma once
+#include "searches.h"
+#include "frecency.h"
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QMutex>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QCache>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// fans each query out to every provider on a worker pool, one generation per query
+class SearchScheduler : public QObject
+{
+  Q_OBJECT
+public:
+  // how long the first paint waits for a provider before showing what's there
+  static constexpr int DEFAULT_BUDGET_MS = 8;
+  
+  explicit SearchScheduler(QObject* parent = nullptr);
+  ~SearchScheduler() override;
+  
+  // takes ownership, ties in the merged list keep the order providers were added
+  void addProvider(Search* provider, int budgetMs = DEFAULT_BUDGET_MS);
+  
+  // load the launch history, then start every provider's load() in the
+  // background; call once after adding them
+  void load();
+  
+  // start searching for query, superseding any search still in flight; a
+  // query answered recently on the same catalogs is published straight away
+  quint64 submit(const QString& query);
+  
+  // drop whatever is in flight without starting a new search
+  void cancel();
+  
+  quint64 generation() const { return m_generation.load(); }
+  
+  // remember that the result with this id was picked for query, so later
+  // queries rank it first
+  void recordLaunch(const QString& query, const QString& id);
+
+signals:
+  // merged results for the newest generation, emitted once for the first
+  // paint and again whenever a late provider finishes
+  void resultsReady(quint64 generation, const QString& query, const ResultList& results);
+  
+  // some provider published a new catalog, the current query is worth rerunning
+  void catalogChanged();
+
+private:
+  struct Provider
+  {
+    Search* search = nullptr;
+    int budgetMs = DEFAULT_BUDGET_MS;
+    QMutex mutex; // providers keep per-query state, so one query at a time each
+    
+    // ui thread only, reset on every submit
+    ResultList results;
+    bool finished = false;
+  };
+  
+  // merged lists kept for backspacing and retyped queries
+  static constexpr int RESULT_CACHE_SIZE = 64;
+  
+  // each doubling of a result's launch count for the query adds this much,
+  // capped so a habit can't bury a much better match
+  static constexpr int FRECENCY_BOOST = 10;
+  static constexpr int MAX_FRECENCY_BOOST = 40;
+  
+  bool isCurrent(quint64 generation) const { return generation == m_generation.load(); }
+  
+  void runProvider(quint64 generation, int index, const QString& query);
+  void onProviderFinished(quint64 generation, int index, ResultList results);
+  void onCatalogChanged();
+  
+  // raise results by m_boosts and restore the order the merge relies on
+  void applyFrecency(std::vector<SearchResult>& results) const;
+  
+  // publish once every provider is finished or over budget, then on every arrival
+  void publishIfReady();
+  void publish();
+  
+  QThreadPool m_pool;
+  QThreadPool m_loadPool; // separate so loading never holds up queries
+  std::vector<std::unique_ptr<Provider>> m_providers;
+  std::atomic<quint64> m_generation{0};
+  FrecencyStore m_frecency{"launches"};
+  
+  // state of the current generation (ui thread)
+  QString m_query;
+  QElapsedTimer m_elapsed;
+  QTimer m_budgetTimer;
+  bool m_published = false;
+  std::pair<quint64, QString> m_cacheKey; // catalog generation at submit, folded query
+  QHash<QString, double> m_boosts; // result id -> launches for the query's prefix
+  
+  // complete merged lists by (catalog generation, folded query), least
+  // recently used dropped first; cleared whenever a catalog or the launch
+  // history changes, the generation keeps a stale list from ever matching
+  QCache<std::pair<quint64, QString>, ResultList> m_resultCache{RESULT_CACHE_SIZE};
+  quint64 m_catalogGeneration = 0;
+};
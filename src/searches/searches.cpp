@@ -1,38 +1,191 @@
 #include "searches.h"
+#include "catalog.h"
+#include "fuzzy.h"
+#include "prefilter.h"
 #include <QString>
+#include <QMutexLocker>
 #include <algorithm>
+#include <utility>
+
+const CatalogEntry& SearchResult::entry() const
+{ return catalog->entries()[index]; }
+
+void ResultList::keep(const std::shared_ptr<const Catalog>& catalog)
+{
+  if (std::find(catalogs.begin(), catalogs.end(), catalog) == catalogs.end()) { catalogs.push_back(catalog); }
+}
 
 Search::Search(QObject* parent) : QObject(parent) {}
 
-int Search::calculateSimilarity(const QString& query, const QString& text)
+ResultList Search::resultForId(const QString& id) const
+{
+  ResultList list;
+  std::shared_ptr<const Catalog> current = catalog();
+  const int index = current ? current->indexOfId(id) : -1;
+  if (index < 0) return list;
+  
+  list.results.push_back({current.get(), index, 100});
+  list.keep(current);
+  return list;
+}
+
+int Search::calculateSimilarity(QStringView query, QStringView text)
+{ return FuzzyMatcher::score(query, text); }
+
+int Search::scoreEntry(QStringView query, quint64 queryMask, const Catalog& catalog, int index)
+{
+  if (!FuzzyMatcher::mayContain(catalog.masks()[index], queryMask)) return 0;
+  return FuzzyMatcher::score(query, catalog.foldedName(index), catalog.nameBoundaries(index));
+}
+
+QHash<int, int> Search::fieldScores(const Catalog& catalog, QStringView foldedQuery)
+{
+  QHash<int, int> scores;
+  bool first = true;
+  for (QStringView word : Catalog::tokens(foldedQuery)) {
+    const QString prefix = word.toString();
+    
+    // best hit of this word per entry; a single char only counts as a whole
+    // token, as a prefix it would pull in most of the catalog
+    QHash<int, int> wordScores;
+    auto visit = [&](const QString& token, const std::vector<Catalog::Posting>& postings) {
+      const int penalty = token.size() == prefix.size() ? 0 : Catalog::PREFIX_PENALTY;
+      for (const Catalog::Posting& posting : postings) {
+        const int score = Catalog::FIELD_WEIGHTS[posting.field] - penalty;
+        int& best = wordScores[posting.entry];
+        best = qMax(best, score);
+      }
+    };
+    if (prefix.size() == 1) {
+      catalog.visitPrefix(prefix, [&](const QString& token, const std::vector<Catalog::Posting>& postings) {
+        if (token.size() == 1) { visit(token, postings); }
+      });
+    } else {
+      catalog.visitPrefix(prefix, visit);
+    }
+    
+    // every word has to hit, an entry is only as good as its weakest word
+    if (first) {
+      scores = std::move(wordScores);
+      first = false;
+    } else {
+      for (auto it = scores.begin(); it != scores.end();) {
+        auto hit = wordScores.constFind(it.key());
+        if (hit == wordScores.constEnd()) {
+          it = scores.erase(it);
+        } else {
+          it.value() = qMin(it.value(), hit.value());
+          ++it;
+        }
+      }
+    }
+    if (scores.isEmpty()) break;
+  }
+  return scores;
+}
+
+ResultList Search::searchCatalog(const std::shared_ptr<const Catalog>& catalog, const QString& foldedQuery)
 {
-  QString queryLower = query.toLower();
-  QString textLower = text.toLower();
+  ResultList results;
+  if (!catalog || foldedQuery.isEmpty()) return results;
   
-  // exact match gets highest score
-  if (textLower == queryLower) { return 100; }
+  const int entryCount = catalog->size();
   
-  // starts with query gets high score
-  if (textLower.startsWith(queryLower)) { return 90; }
+  // every match needs the query as a subsequence of the name or each query
+  // word as a token prefix, so extending the query can only drop matches -
+  // unless the last word was a single char: that only matched whole tokens,
+  // and as it grows it matches prefixes the last run never looked at. rescan
+  // everything then, when the query was edited otherwise, or when a newer
+  // snapshot came in since
+  const QList<QStringView> lastWords = Catalog::tokens(m_lastQuery);
+  bool narrowing = catalog == m_lastCatalog && !lastWords.isEmpty() && lastWords.last().size() > 1 &&
+                   foldedQuery.startsWith(m_lastQuery);
   
-  // contains query as whole word gets medium-high score
-  if (textLower.contains(" " + queryLower + " ") || 
-      textLower.contains(" " + queryLower) ||
-      textLower.contains(queryLower + " ")) { return 70; }
+  struct Match
+  {
+    int score;
+    int index;
+  };
+  std::vector<Match> matches;
+  const quint64 queryMask = FuzzyMatcher::charMask(foldedQuery);
+  const QHash<int, int> fields = fieldScores(*catalog, foldedQuery);
+  auto scoreAt = [&](int index) {
+    int score = qMax(scoreEntry(foldedQuery, queryMask, *catalog, index), fields.value(index));
+    if (score > 0) { matches.push_back({score, index}); }
+  };
   
-  // contains query anywhere gets medium score
-  if (textLower.contains(queryLower)) { return 50; }
+  if (narrowing) {
+    for (int index : m_lastMatches) {
+      if (index < entryCount) { scoreAt(index); }
+    }
+  } else {
+    // a full scan only scores the entries the prefilter lets through, plus
+    // the field hits whose names might not match at all
+    std::vector<quint64> candidates;
+    Prefilter::candidates(catalog->masks().data(), catalog->masks().size(), queryMask, candidates);
+    for (auto it = fields.constBegin(); it != fields.constEnd(); ++it) {
+      candidates[it.key() / 64] |= quint64(1) << (it.key() % 64);
+    }
+    for (size_t word = 0; word < candidates.size(); ++word) {
+      for (quint64 bits = candidates[word]; bits != 0; bits &= bits - 1) {
+        scoreAt(static_cast<int>(word * 64 + __builtin_ctzll(bits)));
+      }
+    }
+  }
   
-  // check if all characters of query appear in order (fuzzy match)
-  int queryIdx = 0;
-  for (int i = 0; i < textLower.length() && queryIdx < queryLower.length(); ++i) {
-    if (textLower[i] == queryLower[queryIdx]) {
-      queryIdx++;
+  // every match is kept for narrowing, even the ones that won't be shown
+  m_lastCatalog = catalog;
+  m_lastQuery = foldedQuery;
+  m_lastMatches.clear();
+  m_lastMatches.reserve(matches.size());
+  for (const Match& match : matches) { m_lastMatches.push_back(match.index); }
+  
+  // typo hits aren't subsequence matches, so they stay out of the narrowing
+  // state above and are looked up fresh from the trie every time
+  if (static_cast<int>(matches.size()) < TYPO_MIN_HITS && foldedQuery.size() >= TYPO_MIN_LENGTH &&
+      !foldedQuery.contains(QChar(' '))) {
+    const int maxDistance = foldedQuery.size() >= 8 ? 2 : 1;
+    const size_t realMatches = matches.size();
+    for (const auto& hit : catalog->words().search(foldedQuery, maxDistance)) {
+      bool matched = std::any_of(matches.begin(), matches.begin() + realMatches,
+                                 [&](const Match& match) { return match.index == hit.first; });
+      if (!matched) { matches.push_back({TYPO_SCORE - (hit.second - 1) * 10, hit.first}); }
     }
   }
   
-  if (queryIdx == queryLower.length()) { return 30; }
+  // partial sort: cost grows with the rows we keep, not the catalog size
+  const size_t keep = qMin(matches.size(), static_cast<size_t>(MAX_RESULTS));
+  std::partial_sort(matches.begin(), matches.begin() + keep, matches.end(),
+                    [](const Match& a, const Match& b) {
+                      return a.score != b.score ? a.score > b.score : a.index < b.index;
+                    });
+  
+  // results only point at the entries, the snapshot goes along with them
+  results.results.reserve(keep);
+  for (size_t i = 0; i < keep; ++i) { results.results.push_back({catalog.get(), matches[i].index, matches[i].score}); }
+  if (keep > 0) { results.keep(catalog); }
   
-  // no match
-  return 0;
+  return results;
+}
+
+void Search::selectTopResults(std::vector<SearchResult>& results, int limit)
+{
+  const size_t keep = qMin(results.size(), static_cast<size_t>(limit));
+  std::partial_sort(results.begin(), results.begin() + keep, results.end());
+  results.resize(keep);
+}
+
+std::shared_ptr<const Catalog> Search::catalog() const
+{
+  QMutexLocker locker(&m_catalogMutex);
+  return m_catalog;
+}
+
+void Search::publishCatalog(std::shared_ptr<const Catalog> catalog)
+{
+  {
+    QMutexLocker locker(&m_catalogMutex);
+    m_catalog = std::move(catalog);
+  }
+  emit catalogChanged();
 }
@@ -1,42 +1,118 @@
 #pragma once
 #include <QObject>
 #include <QString>
+#include <QStringView>
 #include <QMetaType>
+#include <QMutex>
+#include <QHash>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
+class Catalog;
+struct CatalogEntry;
+
+// a matched catalog entry, by position in the snapshot it came from; the
+// ResultList holding it keeps that snapshot alive, so results are cheap to
+// sort, merge and cache and strings are only read for rows that get painted
 struct SearchResult
 {
-  QString name;
-  QString description;
-  QString exec; // command to execute (for apps)
-  QString data; // additional data (e.g., desktop file path)
+  const Catalog* catalog = nullptr;
+  int index = -1; // into catalog->entries()
   int score = 0; // higher score = better match
   
-  ~SearchResult() noexcept = default;
-  SearchResult() = default;
-  SearchResult(const SearchResult&) = default;
-  SearchResult& operator=(const SearchResult&) = default;
-  SearchResult(SearchResult&&) noexcept = default;
-  SearchResult& operator=(SearchResult&&) noexcept = default;
+  const CatalogEntry& entry() const;
   
   bool operator<(const SearchResult& other) const { return score > other.score; }
 };
 
+static_assert(std::is_trivially_copyable<SearchResult>::value, "results are copied around freely");
+
 Q_DECLARE_METATYPE(SearchResult)
 
+// results together with the catalog snapshots they point into
+struct ResultList
+{
+  std::vector<SearchResult> results;
+  std::vector<std::shared_ptr<const Catalog>> catalogs;
+  
+  // keep catalog alive as long as this list, a no-op if it already is
+  void keep(const std::shared_ptr<const Catalog>& catalog);
+  
+  void clear()
+  {
+    results.clear();
+    catalogs.clear();
+  }
+  size_t size() const { return results.size(); }
+  bool empty() const { return results.empty(); }
+};
+
 class Search : public QObject
 {
   Q_OBJECT
 public:
+  // most rows a provider returns, only the best of these can ever be shown
+  static constexpr int MAX_RESULTS = 50;
+  
   explicit Search(QObject* parent = nullptr);
   virtual ~Search() = default;
   
-  // perform search and return results
-  virtual std::vector<SearchResult> performSearch(const QString& query) = 0;
+  // perform search and return at most MAX_RESULTS results, best first
+  virtual ResultList performSearch(const QString& query) = 0;
+  
+  // the listed entry with this id as a single result, empty if there is none
+  ResultList resultForId(const QString& id) const;
+  
+  // build whatever the provider searches, called once on a worker thread
+  // at startup; queries during the load see what has been published so far
+  virtual void load() {}
   
   // calculate similarity score between query and text (0-100)
-  static int calculateSimilarity(const QString& query, const QString& text);
+  // both must already be folded with Catalog::fold
+  static int calculateSimilarity(QStringView query, QStringView text);
   
+  // fuzzy score of the name of catalog's entry at index; queryMask is
+  // FuzzyMatcher::charMask(query), so most entries are rejected by the masks
+  static int scoreEntry(QStringView query, quint64 queryMask, const Catalog& catalog, int index);
+  
+  // entry index -> best field weight, for entries with a token starting with
+  // every word of the folded query (one pass over the posting lists)
+  static QHash<int, int> fieldScores(const Catalog& catalog, QStringView foldedQuery);
+
 signals:
   void resultSelected(const SearchResult& result);
+  
+  // a new catalog snapshot was published (may come from a worker thread)
+  void catalogChanged();
+
+protected:
+  // score catalog entries against a folded query, only rescoring the last
+  // query's matches when the new query extends it on the same snapshot;
+  // returns the top MAX_RESULTS
+  ResultList searchCatalog(const std::shared_ptr<const Catalog>& catalog, const QString& foldedQuery);
+  
+  // latest published snapshot, null until the first publish
+  std::shared_ptr<const Catalog> catalog() const;
+  
+  // swap in a new snapshot and emit catalogChanged, safe from any thread
+  void publishCatalog(std::shared_ptr<const Catalog> catalog);
+  
+  // trim to the best limit results in order, without sorting the rest
+  static void selectTopResults(std::vector<SearchResult>& results, int limit = MAX_RESULTS);
+
+private:
+  // the typo tier only runs when a single-word query found fewer than
+  // TYPO_MIN_HITS real matches, and ranks its hits below exact spellings
+  static constexpr int TYPO_MIN_HITS = 3;
+  static constexpr int TYPO_MIN_LENGTH = 4;
+  static constexpr int TYPO_SCORE = 40; // one edit, less 10 per further edit
+  
+  mutable QMutex m_catalogMutex; // guards m_catalog only, snapshots are immutable
+  std::shared_ptr<const Catalog> m_catalog;
+  
+  // narrowing state, only touched by performSearch
+  std::shared_ptr<const Catalog> m_lastCatalog; // snapshot m_lastMatches indexes into
+  QString m_lastQuery; // empty when there is nothing to narrow from
+  std::vector<int> m_lastMatches; // catalog indices that matched m_lastQuery
 };
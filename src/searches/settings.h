@@ -1,33 +1,12 @@
 #pragma once
-#include "searches.h"
-#include <QString>
-#include <QList>
+#include "desktopsearch.h"
 
-struct SettingsInfo
-{
-  QString name;
-  QString exec;
-  QString description;
-  QString desktopFile;
-};
-
-class SettingsSearch : public Search
+class SettingsSearch : public DesktopSearch
 {
   Q_OBJECT
 public:
-  explicit SettingsSearch(QObject* parent = nullptr);
-  
-  std::vector<SearchResult> performSearch(const QString& query) override;
-  
-private:
-  void loadSettings();
-  
-  // parse .desktop file and extract settings info
-  SettingsInfo parseDesktopFile(const QString& filePath);
-  
-  // get desktop file directories
-  QStringList getDesktopFileDirectories();
+  explicit SettingsSearch(CatalogBuilder* builder, QObject* parent = nullptr);
   
-  QList<SettingsInfo> m_settings;
-  bool m_settingsLoaded = false;
+  // gnome control center panels
+  bool accepts(const DesktopEntry& entry) const override;
 };
@@ -0,0 +1,17 @@
+#pragma once
+#include "catalog.h"
+#include <QString>
+
+// a built-in menu (font demo and the like) as the launcher lists it
+struct SpotlightAppInfo
+{
+  QString identifier;
+  QString name;
+  QString description;
+  QString foldedName; // folded once for matching
+  QString foldedDescription;
+  
+  SpotlightAppInfo(const QString& id, const QString& n, const QString& desc)
+    : identifier(id), name(n), description(desc),
+      foldedName(Catalog::fold(n)), foldedDescription(Catalog::fold(desc)) {}
+};
@@ -0,0 +1,54 @@
+#include "spotlightapps.h"
+#include "catalog.h"
+#include <memory>
+#include <utility>
+
+SpotlightAppsSearch::SpotlightAppsSearch(QObject* parent) : Search(parent) {}
+
+void SpotlightAppsSearch::addApp(const SpotlightAppInfo& app)
+{
+  // results point into a catalog like every other provider's; apps are few
+  // and registered once, so a new snapshot per app is fine
+  std::shared_ptr<const Catalog> current = catalog();
+  Catalog updated = current ? *current : Catalog();
+  
+  CatalogEntry entry;
+  entry.name = app.name;
+  entry.description = app.description;
+  entry.exec = "spotlightapp:" + app.identifier;
+  entry.id = entry.exec;
+  if (!updated.append(std::move(entry))) return;
+  
+  m_apps.append(app);
+  publishCatalog(std::make_shared<const Catalog>(std::move(updated)));
+}
+
+ResultList SpotlightAppsSearch::performSearch(const QString& query)
+{
+  ResultList results;
+  const QString foldedQuery = Catalog::fold(query);
+  std::shared_ptr<const Catalog> snapshot = catalog();
+  if (!snapshot) return results;
+  
+  // an app registered after the snapshot was taken isn't in it yet
+  const int count = qMin(static_cast<int>(m_apps.size()), snapshot->size());
+  for (int i = 0; i < count; ++i) {
+    const SpotlightAppInfo& appInfo = m_apps[i];
+    int score = 0;
+    
+    if (appInfo.foldedName.contains(foldedQuery)) {
+      score = 90;
+    } else if (appInfo.foldedDescription.contains(foldedQuery)) {
+      score = 70;
+    } else if (query.isEmpty() || foldedQuery.length() < 2) {
+      score = 50;
+    }
+    
+    if (score > 0) { results.results.push_back({snapshot.get(), i, score}); }
+  }
+  
+  selectTopResults(results.results);
+  if (!results.empty()) { results.keep(snapshot); }
+  
+  return results;
+}
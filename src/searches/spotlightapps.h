@@ -0,0 +1,21 @@
+#pragma once
+#include "searches.h"
+#include "spotlightappinfo.h"
+#include <QString>
+#include <QList>
+
+// matches registered spotlight apps (built-in menus like the font demo)
+class SpotlightAppsSearch : public Search
+{
+  Q_OBJECT
+public:
+  explicit SpotlightAppsSearch(QObject* parent = nullptr);
+  
+  // register before the provider is handed to the scheduler
+  void addApp(const SpotlightAppInfo& app);
+  
+  ResultList performSearch(const QString& query) override;
+  
+private:
+  QList<SpotlightAppInfo> m_apps; // in the same order as the catalog
+};
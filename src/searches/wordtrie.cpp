@@ -0,0 +1,115 @@
+#include "wordtrie.h"
+#include <algorithm>
+#include <limits>
+
+WordTrie::WordTrie()
+{ clear(); }
+
+void WordTrie::clear()
+{
+  m_nodes.clear();
+  m_nodes.emplace_back();
+}
+
+void WordTrie::insertWords(QStringView foldedText, int entry)
+{
+  qsizetype start = -1;
+  for (qsizetype i = 0; i <= foldedText.size(); ++i) {
+    bool inWord = i < foldedText.size() && foldedText[i].isLetterOrNumber();
+    if (inWord && start < 0) {
+      start = i;
+    } else if (!inWord && start >= 0) {
+      insertWord(foldedText.mid(start, i - start), entry);
+      start = -1;
+    }
+  }
+}
+
+void WordTrie::insertWord(QStringView word, int entry)
+{
+  int node = 0;
+  for (QChar c : word) {
+    auto& children = m_nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), c,
+                               [](const std::pair<QChar, int>& child, QChar key) { return child.first < key; });
+    if (it != children.end() && it->first == c) {
+      node = it->second;
+      continue;
+    }
+    
+    // emplace_back may move the nodes, so note the index before inserting
+    int child = static_cast<int>(m_nodes.size());
+    children.insert(it, {c, child});
+    m_nodes.emplace_back();
+    node = child;
+  }
+  
+  auto& entries = m_nodes[node].entries;
+  if (entries.empty() || entries.back() != entry) { entries.push_back(entry); }
+}
+
+void WordTrie::removeEntry(int entry)
+{
+  // nodes a word no longer reaches stay, they just collect nothing
+  for (Node& node : m_nodes) {
+    auto it = std::lower_bound(node.entries.begin(), node.entries.end(), entry);
+    if (it != node.entries.end() && *it == entry) { it = node.entries.erase(it); }
+    for (; it != node.entries.end(); ++it) { --*it; }
+  }
+}
+
+std::vector<std::pair<int, int>> WordTrie::search(QStringView word, int maxDistance) const
+{
+  // distances[entry] is the best distance seen, INT_MAX for none
+  std::vector<int> distances;
+  
+  std::vector<int> firstRow(word.size() + 1);
+  for (qsizetype j = 0; j <= word.size(); ++j) { firstRow[j] = static_cast<int>(j); }
+  
+  for (const auto& child : m_nodes[0].children) {
+    walk(child.second, child.first, firstRow, word, maxDistance, distances);
+  }
+  
+  std::vector<std::pair<int, int>> hits;
+  for (int entry = 0; entry < static_cast<int>(distances.size()); ++entry) {
+    if (distances[entry] <= maxDistance) { hits.emplace_back(entry, distances[entry]); }
+  }
+  return hits;
+}
+
+void WordTrie::walk(int node, QChar c, const std::vector<int>& previousRow, QStringView word, int maxDistance,
+                    std::vector<int>& distances) const
+{
+  // next row of the edit distance table between word and this node's prefix
+  const qsizetype length = word.size();
+  std::vector<int> row(length + 1);
+  row[0] = previousRow[0] + 1;
+  int best = row[0];
+  for (qsizetype j = 1; j <= length; ++j) {
+    int substitution = previousRow[j - 1] + (word[j - 1] == c ? 0 : 1);
+    row[j] = std::min({row[j - 1] + 1, previousRow[j] + 1, substitution});
+    best = std::min(best, row[j]);
+  }
+  
+  // the whole word matched this prefix closely enough, take every word below
+  if (row[length] <= maxDistance) {
+    collect(node, row[length], distances);
+    return;
+  }
+  
+  // no cell can get back under the limit further down
+  if (best > maxDistance) return;
+  
+  for (const auto& child : m_nodes[node].children) {
+    walk(child.second, child.first, row, word, maxDistance, distances);
+  }
+}
+
+void WordTrie::collect(int node, int distance, std::vector<int>& distances) const
+{
+  for (int entry : m_nodes[node].entries) {
+    if (entry >= static_cast<int>(distances.size())) { distances.resize(entry + 1, std::numeric_limits<int>::max()); }
+    distances[entry] = std::min(distances[entry], distance);
+  }
+  for (const auto& child : m_nodes[node].children) { collect(child.second, distance, distances); }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <QChar>
+#include <QStringView>
+#include <utility>
+#include <vector>
+
+// trie of the words in a catalog's folded names, walked with a Levenshtein
+// automaton (one DP row per node) to find entries within a few typos
+class WordTrie
+{
+public:
+  WordTrie();
+  
+  void clear();
+  
+  // index every word of foldedText under entry
+  void insertWords(QStringView foldedText, int entry);
+  
+  // forget entry and move every later entry down by one, the way a catalog
+  // erase shifts them
+  void removeEntry(int entry);
+  
+  // entries with a word that starts within maxDistance edits of word, as
+  // (entry, distance) with the smallest distance per entry
+  std::vector<std::pair<int, int>> search(QStringView word, int maxDistance) const;
+
+private:
+  struct Node
+  {
+    std::vector<std::pair<QChar, int>> children; // sorted by char
+    std::vector<int> entries; // entries with a word ending here
+  };
+  
+  void insertWord(QStringView word, int entry);
+  void walk(int node, QChar c, const std::vector<int>& previousRow, QStringView word, int maxDistance,
+            std::vector<int>& distances) const;
+  void collect(int node, int distance, std::vector<int>& distances) const;
+  
+  std::vector<Node> m_nodes; // m_nodes[0] is the root
+};
@@ -0,0 +1,104 @@
+#include "singleinstance.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QFile>
+#include <QStandardPaths>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+
+namespace {
+
+// the hotkey is waiting on this, so a dead socket shouldn't hold it up long
+constexpr int CONNECT_TIMEOUT_MS = 100;
+const QByteArray TOGGLE = "toggle\n";
+
+} // namespace
+
+SingleInstance::SingleInstance(QObject* parent) : QObject(parent) {}
+
+SingleInstance::~SingleInstance()
+{
+  if (m_lockFd >= 0) { ::close(m_lockFd); }
+}
+
+bool SingleInstance::isRunning()
+{
+  int fd = connectToRunning();
+  if (fd < 0) return false;
+  
+  ::close(fd);
+  return true;
+}
+
+bool SingleInstance::toggleRunning()
+{
+  int fd = connectToRunning();
+  if (fd < 0) return false;
+  
+  ::send(fd, TOGGLE.constData(), static_cast<size_t>(TOGGLE.size()), MSG_NOSIGNAL);
+  ::close(fd);
+  return true;
+}
+
+bool SingleInstance::listen()
+{
+  // two starts at once both find nobody answering; the lock picks one, and
+  // the kernel drops it with the process however that ends
+  const QByteArray lockPath = QFile::encodeName(socketPath() + ".lock");
+  m_lockFd = ::open(lockPath.constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (m_lockFd < 0 || ::flock(m_lockFd, LOCK_EX | LOCK_NB) != 0) return false;
+  
+  m_server = new QLocalServer(this);
+  m_server->setSocketOptions(QLocalServer::UserAccessOption);
+  connect(m_server, &QLocalServer::newConnection, this, &SingleInstance::onNewConnection);
+  
+  // with the lock held nobody else can be listening, so a socket file still
+  // there was left by a crash
+  if (m_server->listen(socketPath())) return true;
+  QLocalServer::removeServer(socketPath());
+  return m_server->listen(socketPath());
+}
+
+void SingleInstance::onNewConnection()
+{
+  while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+    connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+      while (socket->canReadLine()) {
+        if (socket->readLine() == TOGGLE) { emit toggleRequested(); }
+      }
+    });
+  }
+}
+
+QString SingleInstance::socketPath()
+{
+  // the runtime dir is per user, so is the socket
+  return QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation) + "/spotlight.sock";
+}
+
+int SingleInstance::connectToRunning()
+{
+  const QByteArray path = QFile::encodeName(socketPath());
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (static_cast<size_t>(path.size()) >= sizeof(address.sun_path)) return -1;
+  std::memcpy(address.sun_path, path.constData(), static_cast<size_t>(path.size()));
+  
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+  
+  // bounds the connect and the write, a wedged instance can't hang the hotkey
+  timeval timeout{0, CONNECT_TIMEOUT_MS * 1000};
+  ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
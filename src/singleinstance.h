@@ -0,0 +1,40 @@
+#pragma once
+#include <QObject>
+#include <QString>
+
+class QLocalServer;
+
+// keeps one resident spotlight per user session: the first process listens on
+// a local socket in $XDG_RUNTIME_DIR, later ones just ask it to toggle
+class SingleInstance : public QObject
+{
+  Q_OBJECT
+public:
+  explicit SingleInstance(QObject* parent = nullptr);
+  ~SingleInstance() override;
+  
+  // whether another process is already the running instance; this and
+  // toggleRunning use a plain socket, so they work before QApplication exists
+  static bool isRunning();
+  
+  // ask the running instance to toggle its window, false if there is none
+  static bool toggleRunning();
+  
+  // become the running instance, false if another process already is or
+  // the socket can't be created
+  bool listen();
+
+signals:
+  void toggleRequested();
+
+private:
+  void onNewConnection();
+  
+  static QString socketPath();
+  
+  // connected socket to the running instance, -1 if there is none
+  static int connectToRunning();
+  
+  QLocalServer* m_server = nullptr;
+  int m_lockFd = -1; // flock'd for as long as this is the running instance
+};